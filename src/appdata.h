@@ -14,6 +14,7 @@ typedef struct _Station
    const char *language;
    const char *codec;
    const char *tags;
+   const char *label;      // row text, built once by station_label_update()
    int bitrate;
    Eina_Bool favorite;
 } Station;
@@ -23,6 +24,11 @@ typedef enum {
    VIEW_FAVORITES
 } ViewMode;
 
+typedef enum {
+   API_FORMAT_XML,
+   API_FORMAT_JSON
+} ApiFormat;
+
 typedef struct _AppData
 {
    Evas_Object *win;
@@ -48,9 +54,12 @@ typedef struct _AppData
    Evas_Object *progressbar;   // loading indicator
    Evas_Object *sort_hoversel;
    Evas_Object *reverse_check;
+   Evas_Object *instant_search_check;  // search while typing
    Eina_List *stations;
    Eina_List *api_servers;    // list of strings (hostnames)
    const char *api_selected;  // currently selected server hostname
+   ApiFormat api_format;      // response format requested from the API
+   Eina_Bool hedge_requests;  // race a second mirror when the first is slow
    Eina_Bool playing;
    Eina_Bool filters_visible;
    int loading_requests;       // refcount of in-flight HTTP requests
@@ -60,6 +69,17 @@ typedef struct _AppData
    int search_offset;
    int displayed_stations_count;
 
+   // Paged search: the active query, fetched one page at a time
+   const char *search_term;
+   const char *search_type;
+   const char *search_order;
+   Eina_Bool search_reverse;
+   Eina_Bool search_has_more;      // last page came back full
+   Eina_Bool search_page_pending;  // a page request is in flight
+   Station *prefetch_trigger;      // realizing this row requests the next page
+   const char *stations_key;       // result cache key of the query in stations
+   unsigned int search_generation; // bumped by every new search
+
    // Visualizer
    Evas_Object *visualizer_win;
    Evas_Object *visualizer_emotion;
@@ -0,0 +1,108 @@
+// Compare the XML and JSON station parsers on saved responses for the same
+// query, e.g.
+//   curl -o r.xml 'http://de2.api.radio-browser.info/xml/stations/search?tag=rock&limit=1000'
+//   curl -o r.json 'http://de2.api.radio-browser.info/json/stations/search?tag=rock&limit=1000'
+//   ./eradio-bench r.xml r.json 50
+#include <Eina.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "station_parser.h"
+
+// Same order of magnitude as the chunks Ecore_Con_Url delivers
+#define BENCH_CHUNK_SIZE 16384
+
+static void
+_bench_batch_cb(void *data EINA_UNUSED, Eina_List *batch)
+{
+   Station *st;
+   EINA_LIST_FREE(batch, st)
+     station_free(st);
+}
+
+static double
+_now(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static char *
+_read_file(const char *path, long *size)
+{
+   FILE *f = fopen(path, "rb");
+   char *buf;
+
+   if (!f) return NULL;
+   fseek(f, 0, SEEK_END);
+   *size = ftell(f);
+   fseek(f, 0, SEEK_SET);
+   buf = malloc(*size > 0 ? *size : 1);
+   if (buf && fread(buf, 1, *size, f) != (size_t)*size)
+     {
+        free(buf);
+        buf = NULL;
+     }
+   fclose(f);
+   return buf;
+}
+
+static int
+_bench(const char *label, ApiFormat format, const char *path, int iterations)
+{
+   long size = 0;
+   char *buf = _read_file(path, &size);
+   int count = 0;
+   double start, elapsed;
+
+   if (!buf)
+     {
+        fprintf(stderr, "Could not read %s\n", path);
+        return 1;
+     }
+
+   start = _now();
+   for (int i = 0; i < iterations; i++)
+     {
+        Station_Parser *p = station_parser_new(format, _bench_batch_cb, NULL);
+        for (long off = 0; off < size; off += BENCH_CHUNK_SIZE)
+          {
+             long len = size - off < BENCH_CHUNK_SIZE ? size - off : BENCH_CHUNK_SIZE;
+             station_parser_feed(p, buf + off, len);
+          }
+        if (!station_parser_finish(p))
+          fprintf(stderr, "%s: parse error in %s\n", label, path);
+        count = station_parser_count_get(p);
+        station_parser_free(p);
+     }
+   elapsed = (_now() - start) / iterations;
+
+   printf("%-4s %8d stations %10ld bytes %8.1f bytes/station %8.3f ms/parse %8.1f MB/s\n",
+          label, count, size, count ? (double)size / count : 0.0,
+          elapsed * 1000.0, size / elapsed / (1024.0 * 1024.0));
+   free(buf);
+   return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+   int iterations = 20;
+   int ret = 0;
+
+   if (argc < 3)
+     {
+        fprintf(stderr, "Usage: %s results.xml results.json [iterations]\n", argv[0]);
+        return 1;
+     }
+   if (argc > 3) iterations = atoi(argv[3]);
+   if (iterations < 1) iterations = 1;
+
+   eina_init();
+   ret |= _bench("xml", API_FORMAT_XML, argv[1], iterations);
+   ret |= _bench("json", API_FORMAT_JSON, argv[2], iterations);
+   eina_shutdown();
+   return ret;
+}
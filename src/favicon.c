@@ -0,0 +1,559 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "favicon.h"
+#include "favorites.h"
+#include "http.h"
+#include "radio_player.h"
+#include "thumbs.h"
+#include "icon_cache.h"
+
+#define FAVICON_MAX_CONNECTIONS 4
+#define FAVICON_PREFETCH_ROWS 8            // rows below a realized one to fetch ahead
+#define FAVICON_MAX_BYTES (256 * 1024)     // a bigger "favicon" is abandoned
+#define FAVICON_KEY_LEN 17                 // 16 hex digits of the URL hash
+#define FAVICON_WARMUP_DELAY 10.0          // seconds after startup
+#define FAVICON_WARMUP_INTERVAL 2.0        // at most one warm-up download per interval
+#define FAVICON_WARMUP_DECODES 8           // cached warm-up icons decoded per interval
+
+// One download per favicon URL, shared by every row that shows it
+typedef struct _Favicon_Fetch
+{
+   char key[FAVICON_KEY_LEN];
+   const char *url;        // stringshare
+   Eina_List *items;       // rows waiting for this icon
+   Ecore_Con_Url *con;     // NULL while queued
+   Thumbs_Job *decode;     // set while the thumbnail is being made
+   Eina_Bool visible;      // one of the rows is realized, not just prefetched
+   Eina_Bool warmup;       // started for a favorite, kept when the list is cleared
+} Favicon_Fetch;
+
+// Favicon key of a station, remembered per UUID so rows are not rehashed
+typedef struct _Favicon_Key
+{
+   const char *url;        // stringshare the key was computed from
+   char key[FAVICON_KEY_LEN];
+} Favicon_Key;
+
+static AppData *_ad = NULL;
+static Eina_List *_queue = NULL;    // waiting: visible rows first, then prefetches
+static Eina_List *_active = NULL;
+static Eina_List *_decoding = NULL; // downloaded or cached, thumbnail in the works
+static Eina_Hash *_keys = NULL;     // stationuuid -> Favicon_Key
+static Eina_List *_warmup = NULL;   // favorite favicon URLs still to check
+static Ecore_Timer *_warmup_timer = NULL;
+
+static void _pump(void);
+
+static void
+_key_free(void *data)
+{
+   Favicon_Key *k = data;
+   eina_stringshare_del(k->url);
+   free(k);
+}
+
+// Icons are stored under the FNV-1a 64 hash of their URL, so stations
+// sharing a favicon share one file, one download and one thumbnail
+static void
+_url_key(const char *url, char *key)
+{
+   unsigned long long hash = 1469598103934665603ULL;
+
+   for (const unsigned char *p = (const unsigned char *)url; *p; p++)
+     {
+        hash ^= *p;
+        hash *= 1099511628211ULL;
+     }
+   snprintf(key, FAVICON_KEY_LEN, "%016llx", hash);
+}
+
+static const char *
+_key_get(const Station *st)
+{
+   Favicon_Key *k;
+
+   if (!_keys || !st->stationuuid || !st->favicon) return NULL;
+   k = eina_hash_find(_keys, st->stationuuid);
+   if (k && k->url == st->favicon) return k->key;
+
+   if (!k)
+     {
+        k = calloc(1, sizeof(Favicon_Key));
+        if (!k) return NULL;
+        eina_hash_add(_keys, st->stationuuid, k);
+     }
+   _url_key(st->favicon, k->key);
+   eina_stringshare_replace(&k->url, st->favicon);
+   return k->key;
+}
+
+static void
+_item_update(Elm_Object_Item *it)
+{
+   elm_genlist_item_fields_update(it, "elm.swallow.icon", ELM_GENLIST_ITEM_FIELD_CONTENT);
+}
+
+typedef enum _Favicon_Need
+{
+   FAVICON_NONE,
+   FAVICON_DECODE,
+   FAVICON_DOWNLOAD
+} Favicon_Need;
+
+// Rows with a thumbnail need no I/O at all. A favicon downloaded before
+// the atlas existed is imported the first time its row is seen, and one
+// stored under its station UUID is moved to its URL key.
+static Favicon_Need
+_need_get(const Station *st)
+{
+   const char *key;
+
+   if (!st || !st->favicon || !st->favicon[0]) return FAVICON_NONE;
+   key = _key_get(st);
+   if (!key || thumbs_has(key) || icon_cache_failed(st->favicon)) return FAVICON_NONE;
+   if (icon_cache_has(key) || icon_cache_rename(st->stationuuid, key)) return FAVICON_DECODE;
+   return FAVICON_DOWNLOAD;
+}
+
+static Favicon_Fetch *
+_find_key(Eina_List *list, const char *key)
+{
+   Eina_List *l;
+   Favicon_Fetch *f;
+
+   if (!key) return NULL;
+   EINA_LIST_FOREACH(list, l, f)
+     if (!strcmp(f->key, key)) return f;
+   return NULL;
+}
+
+static Favicon_Fetch *
+_find_item(Eina_List *list, Elm_Object_Item *it)
+{
+   Eina_List *l;
+   Favicon_Fetch *f;
+
+   EINA_LIST_FOREACH(list, l, f)
+     if (eina_list_data_find(f->items, it)) return f;
+   return NULL;
+}
+
+static void
+_fetch_free(Favicon_Fetch *f)
+{
+   if (f->decode) thumbs_add_cancel(f->decode);
+   eina_list_free(f->items);
+   eina_stringshare_del(f->url);
+   free(f);
+}
+
+// Insert behind the last visible entry, ahead of all prefetches
+static void
+_queue_visible(Favicon_Fetch *f)
+{
+   Eina_List *l;
+   Favicon_Fetch *q;
+
+   EINA_LIST_FOREACH(_queue, l, q)
+     if (!q->visible)
+       {
+          _queue = eina_list_prepend_relative_list(_queue, f, l);
+          return;
+       }
+   _queue = eina_list_append(_queue, f);
+}
+
+static void
+_decode_done_cb(void *data, const char *key EINA_UNUSED, Eina_Bool ok)
+{
+   Favicon_Fetch *f = data;
+   Elm_Object_Item *it;
+   Eina_List *l;
+
+   f->decode = NULL;
+   _decoding = eina_list_remove(_decoding, f);
+   if (ok)
+     EINA_LIST_FOREACH(f->items, l, it)
+       _item_update(it);
+   else
+     {
+        printf("Favicon %s is not a usable image\n", f->url);
+        icon_cache_failure_add(f->url, EINA_TRUE);
+     }
+   _fetch_free(f);
+}
+
+// Rows get their icon once the thumbnail is in the atlas; nothing is
+// decoded on the main loop
+static void
+_decode_start(Favicon_Fetch *f)
+{
+   char path[PATH_MAX];
+
+   if (icon_cache_path_get(f->key, path, sizeof(path)))
+     f->decode = thumbs_add_file(f->key, path, _decode_done_cb, f);
+   if (!f->decode)
+     {
+        printf("Favicon %s is not a usable image\n", f->url);
+        icon_cache_failure_add(f->url, EINA_TRUE);
+        _fetch_free(f);
+        return;
+     }
+   _decoding = eina_list_append(_decoding, f);
+}
+
+static void
+_fetch_done_cb(void *data, const char *path, size_t size, int status, const char *content_type)
+{
+   Favicon_Fetch *f = data;
+
+   _active = eina_list_remove(_active, f);
+   f->con = NULL;
+   if (path && content_type && strncasecmp(content_type, "image/", 6) == 0)
+     {
+        icon_cache_add(f->key, f->url, size);
+        _decode_start(f);
+        _pump();
+        return;
+     }
+   else
+     {
+        // Missing, empty, oversized and non-image icons will not get better
+        // soon; timeouts, throttling, server errors and a full or read-only
+        // cache directory may
+        Eina_Bool permanent = (path != NULL) || (status == 200) ||
+                              (status >= 400 && status < 500 && status != 408 && status != 429);
+        if (status == HTTP_ICON_LOCAL_ERROR)
+          printf("Favicon %s could not be stored\n", f->url);
+        else
+          printf("Favicon %s failed (HTTP %d, %s)\n", f->url,
+                 status, content_type && content_type[0] ? content_type : "no image");
+        icon_cache_failure_add(f->url, permanent);
+        // A body that is not an image must not pass for a cached icon
+        if (path) unlink(path);
+     }
+   _fetch_free(f);
+   _pump();
+}
+
+static void
+_pump(void)
+{
+   while (_queue && eina_list_count(_active) < FAVICON_MAX_CONNECTIONS)
+     {
+        Favicon_Fetch *f = eina_list_data_get(_queue);
+        char path[PATH_MAX];
+
+        _queue = eina_list_remove_list(_queue, _queue);
+        if (icon_cache_path_get(f->key, path, sizeof(path)))
+          f->con = http_download_icon(_ad, f->url, path, FAVICON_MAX_BYTES, _fetch_done_cb, f);
+        if (!f->con)
+          {
+             _fetch_free(f);
+             continue;
+          }
+        _active = eina_list_append(_active, f);
+     }
+}
+
+static Favicon_Fetch *
+_fetch_new(const char *key, const char *url)
+{
+   Favicon_Fetch *f = calloc(1, sizeof(Favicon_Fetch));
+
+   if (!f) return NULL;
+   strcpy(f->key, key);
+   f->url = eina_stringshare_ref(url);
+   return f;
+}
+
+// Attach row it to the fetch already running or queued for its icon.
+// Returns a new, not yet queued fetch if there was none.
+static Favicon_Fetch *
+_fetch_join(Elm_Object_Item *it, const Station *st, Favicon_Fetch **existing)
+{
+   const char *key = _key_get(st);
+   Favicon_Fetch *f;
+
+   *existing = NULL;
+   if (!key) return NULL;
+   if ((f = _find_key(_active, key)) || (f = _find_key(_queue, key)) ||
+       (f = _find_key(_decoding, key)))
+     {
+        if (!eina_list_data_find(f->items, it))
+          f->items = eina_list_append(f->items, it);
+        *existing = f;
+        return NULL;
+     }
+
+   f = _fetch_new(key, st->favicon);
+   if (f) f->items = eina_list_append(f->items, it);
+   return f;
+}
+
+// Prefetches left behind by a change of scroll direction are dropped,
+// oldest first
+static void
+_trim_prefetch(void)
+{
+   Eina_List *l, *l_next;
+   Favicon_Fetch *f;
+   int excess = -2 * FAVICON_PREFETCH_ROWS;
+
+   EINA_LIST_FOREACH(_queue, l, f)
+     if (!f->visible) excess++;
+   EINA_LIST_FOREACH_SAFE(_queue, l, l_next, f)
+     {
+        if (excess <= 0) break;
+        if (f->visible || f->warmup) continue;
+        _queue = eina_list_remove_list(_queue, l);
+        _fetch_free(f);
+        excess--;
+     }
+}
+
+// Attach row it to whatever is under way for its icon, or start what it
+// needs: a thumbnail from the cached file, or a download
+static void
+_request(Elm_Object_Item *it, const Station *st, Eina_Bool visible)
+{
+   Favicon_Need need = _need_get(st);
+   Favicon_Fetch *f, *existing;
+
+   if (need == FAVICON_NONE) return;
+   f = _fetch_join(it, st, &existing);
+   if (existing)
+     {
+        if (visible && !existing->visible)
+          {
+             existing->visible = EINA_TRUE;
+             // A prefetched icon came into view: move it up with the visible ones
+             if (eina_list_data_find(_queue, existing))
+               {
+                  _queue = eina_list_remove(_queue, existing);
+                  _queue_visible(existing);
+               }
+          }
+        return;
+     }
+   if (!f) return;
+
+   f->visible = visible;
+   if (need == FAVICON_DECODE)
+     _decode_start(f);
+   else if (visible)
+     _queue_visible(f);
+   else
+     _queue = eina_list_append(_queue, f);
+}
+
+static void
+_prefetch_after(Elm_Object_Item *it)
+{
+   Elm_Object_Item *next = it;
+
+   for (int i = 0; i < FAVICON_PREFETCH_ROWS; i++)
+     {
+        next = elm_genlist_item_next_get(next);
+        if (!next) break;
+        _request(next, elm_object_item_data_get(next), EINA_FALSE);
+     }
+   _trim_prefetch();
+}
+
+// Favorites get their thumbnails in the background, so the favorites view
+// opens without a single request. Each tick decodes a few cached files or
+// starts one download, and only while no row is waiting for an icon, no
+// thumbnail is being made and no stream is starting.
+static Eina_Bool
+_warmup_cb(void *data EINA_UNUSED)
+{
+   const char *url;
+   char key[FAVICON_KEY_LEN];
+   Favicon_Fetch *f;
+   int decodes = 0;
+
+   if (radio_player_is_starting() || _queue || _active || _decoding) return ECORE_CALLBACK_RENEW;
+
+   EINA_LIST_FREE(_warmup, url)
+     {
+        Eina_Bool download;
+
+        _url_key(url, key);
+        if (thumbs_has(key) || icon_cache_failed(url) ||
+            _find_key(_active, key) || _find_key(_queue, key) || _find_key(_decoding, key) ||
+            !(f = _fetch_new(key, url)))
+          {
+             eina_stringshare_del(url);
+             continue;
+          }
+        eina_stringshare_del(url);
+        f->warmup = EINA_TRUE;
+
+        download = !icon_cache_has(key);
+        if (!download)
+          {
+             _decode_start(f);
+             if (++decodes >= FAVICON_WARMUP_DECODES) return ECORE_CALLBACK_RENEW;
+          }
+        else
+          {
+             _queue = eina_list_append(_queue, f);
+             _pump();
+             return ECORE_CALLBACK_RENEW;
+          }
+     }
+
+   _warmup_timer = NULL;
+   return ECORE_CALLBACK_CANCEL;
+}
+
+static Eina_Bool
+_warmup_start_cb(void *data EINA_UNUSED)
+{
+   _warmup = favorites_favicons_get(_ad);
+   if (!_warmup)
+     {
+        _warmup_timer = NULL;
+        return ECORE_CALLBACK_CANCEL;
+     }
+   printf("Favicon warm-up: checking %u favorites\n", eina_list_count(_warmup));
+   _warmup_timer = ecore_timer_add(FAVICON_WARMUP_INTERVAL, _warmup_cb, NULL);
+   return ECORE_CALLBACK_CANCEL;
+}
+
+void
+favicon_init(AppData *ad)
+{
+   _ad = ad;
+   _keys = eina_hash_string_superfast_new(_key_free);
+   // A thumbnail lives only as long as its icon file, so the atlas stays
+   // within the cache budget too
+   icon_cache_evict_cb_set(thumbs_del);
+   icon_cache_init();
+   thumbs_prune(icon_cache_has);
+   _warmup_timer = ecore_timer_add(FAVICON_WARMUP_DELAY, _warmup_start_cb, NULL);
+}
+
+void
+favicon_shutdown(void)
+{
+   Favicon_Fetch *f;
+   const char *url;
+
+   if (_warmup_timer) ecore_timer_del(_warmup_timer);
+   _warmup_timer = NULL;
+   EINA_LIST_FREE(_warmup, url)
+     eina_stringshare_del(url);
+
+   favicon_cancel_all();
+   EINA_LIST_FREE(_active, f)
+     {
+        http_download_icon_cancel(f->con);
+        _fetch_free(f);
+     }
+   EINA_LIST_FREE(_decoding, f)
+     _fetch_free(f);
+   icon_cache_shutdown();
+   if (_keys) eina_hash_free(_keys);
+   _keys = NULL;
+   _ad = NULL;
+}
+
+void
+favicon_item_realized(Elm_Object_Item *it)
+{
+   _request(it, elm_object_item_data_get(it), EINA_TRUE);
+   _prefetch_after(it);
+   _pump();
+}
+
+void
+favicon_item_unrealized(Elm_Object_Item *it)
+{
+   Favicon_Fetch *f;
+
+   // A fetch is dropped once no row is waiting for it any more
+   if ((f = _find_item(_queue, it)))
+     {
+        f->items = eina_list_remove(f->items, it);
+        if (f->items || f->warmup) return;
+        _queue = eina_list_remove(_queue, f);
+        _fetch_free(f);
+     }
+   else if ((f = _find_item(_active, it)))
+     {
+        f->items = eina_list_remove(f->items, it);
+        if (f->items || f->warmup) return;
+        _active = eina_list_remove(_active, f);
+        http_download_icon_cancel(f->con);
+        _fetch_free(f);
+        _pump();
+     }
+   else if ((f = _find_item(_decoding, it)))
+     {
+        // The thumbnail is worth finishing even if no row waits for it
+        f->items = eina_list_remove(f->items, it);
+     }
+}
+
+void
+favicon_cancel_all(void)
+{
+   Favicon_Fetch *f;
+   Eina_List *l, *l_next;
+
+   EINA_LIST_FREE(_queue, f)
+     _fetch_free(f);
+   EINA_LIST_FOREACH_SAFE(_active, l, l_next, f)
+     {
+        // Warm-up downloads are not for any row and carry on
+        if (f->warmup)
+          {
+             f->items = eina_list_free(f->items);
+             continue;
+          }
+        _active = eina_list_remove_list(_active, l);
+        http_download_icon_cancel(f->con);
+        _fetch_free(f);
+     }
+   EINA_LIST_FOREACH(_decoding, l, f)
+     f->items = eina_list_free(f->items);
+}
+
+Eina_Bool
+favicon_object_reuse(Evas_Object *obj, const Station *st)
+{
+   const char *key;
+
+   if (!st->favicon || !st->favicon[0]) return EINA_FALSE;
+   key = _key_get(st);
+   if (!key || !thumbs_object_set(obj, key)) return EINA_FALSE;
+   icon_cache_touch(key);
+   return EINA_TRUE;
+}
+
+Eina_Bool
+favicon_has(const Station *st)
+{
+   const char *key;
+
+   if (!st->favicon || !st->favicon[0]) return EINA_FALSE;
+   key = _key_get(st);
+   return key && thumbs_has(key);
+}
+
+Evas_Object *
+favicon_object_add(Evas_Object *parent, const Station *st)
+{
+   const char *key;
+
+   if (!st->favicon || !st->favicon[0]) return NULL;
+   key = _key_get(st);
+   if (!key) return NULL;
+   icon_cache_touch(key);
+   return thumbs_object_add(parent, key);
+}
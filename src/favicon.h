@@ -0,0 +1,28 @@
+#pragma once
+
+#include "appdata.h"
+
+// Favicons are fetched for rows as the genlist realizes them: visible rows
+// first, then a few rows ahead of the scroll, with a bounded number of
+// connections. Fetches for rows that scroll away are cancelled.
+
+void favicon_init(AppData *ad);
+void favicon_shutdown(void);
+
+// Genlist "realized" / "unrealized" hooks
+void favicon_item_realized(Elm_Object_Item *it);
+void favicon_item_unrealized(Elm_Object_Item *it);
+
+// Drop every queued and running fetch; called before the list is cleared
+void favicon_cancel_all(void);
+
+// Image object with the thumbnail of st's favicon, or NULL if it is not
+// cached yet. Reads only the shared thumbnail atlas.
+Evas_Object *favicon_object_add(Evas_Object *parent, const Station *st);
+
+// Show st's thumbnail in obj, an object from favicon_object_add() that a
+// row gave up. Returns EINA_FALSE if st has no thumbnail yet.
+Eina_Bool favicon_object_reuse(Evas_Object *obj, const Station *st);
+
+// st's thumbnail is ready
+Eina_Bool favicon_has(const Station *st);
@@ -1,6 +1,7 @@
 #include <libxml/parser.h>
 #include <libxml/tree.h>
 #include <sys/stat.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <errno.h>
 #include <string.h>
@@ -8,6 +9,8 @@
 #include <stdio.h>
 
 #include "favorites.h"
+#include "station_parser.h"
+#include "station_list.h"
 
 typedef struct {
     char *key;   // uuid or url
@@ -15,8 +18,34 @@ typedef struct {
     char *url;
     char *name;
     char *favicon;
+    Station *station;   // this favorite in ad->favorites_stations, once built
+    Eina_List *node;    // its node there, for removal in constant time
 } FavEntry;
 
+#define FAVORITES_COMPACT_DELAY 2.0   // seconds without changes before favorites.xml is rewritten
+#define FAVORITES_RETRY_MAX 300.0     // longest wait before retrying a failed rewrite
+
+typedef struct {
+    AppData *ad;          // NULL once favorites_shutdown() ran
+    FavEntry *entries;    // copies of the hash entries, owned by the job
+    unsigned int count;
+    off_t journal_len;    // journal bytes the copies include
+    char *path;
+    Eina_Bool ok;
+    const char *error;
+} Compact_Job;
+
+static Eina_Bool _stations_built = EINA_FALSE;
+
+// Changes go to an append-only journal first and are folded into
+// favorites.xml later, off the main loop
+static int _journal_fd = -1;
+static off_t _journal_len = 0;                    // bytes of complete records
+static Ecore_Timer *_compact_timer = NULL;
+static Compact_Job *_compact_job = NULL;
+static Eina_Bool _compact_again = EINA_FALSE;     // changes since the job's copy
+static double _compact_retry = FAVORITES_COMPACT_DELAY;   // doubles per failed rewrite
+
 static void _fav_entry_free(void *data)
 {
     FavEntry *e = data;
@@ -53,6 +82,32 @@ _favorites_file_path(void)
     return p;
 }
 
+static char *
+_favorites_journal_path(void)
+{
+    const char *home = getenv("HOME");
+    if (!home) return NULL;
+    size_t len = strlen(home) + strlen("/.config/eradio/favorites.journal") + 1;
+    char *p = malloc(len);
+    if (!p) return NULL;
+    snprintf(p, len, "%s/.config/eradio/favorites.journal", home);
+    return p;
+}
+
+// Make renames and new files in the config directory durable. Safe to
+// call from a worker thread.
+static Eina_Bool
+_favorites_dir_sync(void)
+{
+    char *dir = _favorites_dir_path();
+    if (!dir) return EINA_FALSE;
+    int fd = open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    Eina_Bool ok = fd >= 0 && fsync(fd) == 0;
+    if (fd >= 0) close(fd);
+    free(dir);
+    return ok;
+}
+
 static Eina_Bool
 _ensure_dir_exists(const char *path)
 {
@@ -101,9 +156,227 @@ _favorites_hash_add_entry(AppData *ad, const char *key, const char *uuid, const
     }
 }
 
+// Journal records are one line each, fields separated by tabs:
+//   "+ key uuid url name favicon"  favorite added or updated
+//   "- key"                        favorite removed
+// Tabs, newlines and backslashes in fields are escaped; an empty field is
+// an unset one.
+static void
+_journal_field_add(Eina_Strbuf *buf, const char *s)
+{
+    eina_strbuf_append_char(buf, '\t');
+    for (; s && *s; s++)
+    {
+        if (*s == '\\') eina_strbuf_append(buf, "\\\\");
+        else if (*s == '\t') eina_strbuf_append(buf, "\\t");
+        else if (*s == '\n') eina_strbuf_append(buf, "\\n");
+        else if (*s == '\r') eina_strbuf_append(buf, "\\r");
+        else eina_strbuf_append_char(buf, *s);
+    }
+}
+
+// Split the next field off *p and unescape it in place
+static char *
+_journal_field_next(char **p)
+{
+    char *start = *p, *in, *out;
+    if (!start) return NULL;
+
+    for (in = out = start; *in && *in != '\t'; in++)
+    {
+        if (*in == '\\' && in[1])
+        {
+            in++;
+            *out++ = *in == 't' ? '\t' : *in == 'n' ? '\n' : *in == 'r' ? '\r' : *in;
+        }
+        else
+            *out++ = *in;
+    }
+    *p = *in ? in + 1 : NULL;
+    *out = '\0';
+    return start[0] ? start : NULL;
+}
+
+static Eina_Bool
+_journal_open(void)
+{
+    if (_journal_fd >= 0) return EINA_TRUE;
+
+    char *dir = _favorites_dir_path();
+    char *path = _favorites_journal_path();
+    if (dir && path && _ensure_dir_exists(dir))
+        _journal_fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+    free(dir);
+    free(path);
+    // The journal may have just been created
+    if (_journal_fd >= 0)
+        _favorites_dir_sync();
+    return _journal_fd >= 0;
+}
+
+// Record one change with a single write and a data sync of that small
+// file, so it survives a crash or power loss; e is NULL for a removal
+static void
+_journal_append(AppData *ad, const char *key, const FavEntry *e)
+{
+    Eina_Strbuf *buf = eina_strbuf_new();
+    if (!buf) return;
+
+    eina_strbuf_append_char(buf, e ? '+' : '-');
+    _journal_field_add(buf, key);
+    if (e)
+    {
+        _journal_field_add(buf, e->uuid);
+        _journal_field_add(buf, e->url);
+        _journal_field_add(buf, e->name);
+        _journal_field_add(buf, e->favicon);
+    }
+    eina_strbuf_append_char(buf, '\n');
+
+    size_t len = eina_strbuf_length_get(buf);
+    ssize_t n = _journal_open() ? write(_journal_fd, eina_strbuf_string_get(buf), len) : -1;
+    if (n == (ssize_t)len && fdatasync(_journal_fd) == 0)
+        _journal_len += n;
+    else
+    {
+        // Cut the journal back to its last complete record, so a torn or
+        // unsynced one is not counted and the next starts on its own line
+        if (n > 0 && ftruncate(_journal_fd, _journal_len) == -1)
+            fprintf(stderr, "Favorites: could not truncate journal: %s\n", strerror(errno));
+        if (ad->statusbar)
+            elm_object_text_set(ad->statusbar, "Error: Could not save favorites (disk full?)");
+    }
+    eina_strbuf_free(buf);
+}
+
+// Apply the journal on top of favorites.xml. A record holds the whole
+// entry, so replaying one the file already includes changes nothing.
+static void
+_journal_replay(AppData *ad)
+{
+    char *path = _favorites_journal_path();
+    char *line = NULL;
+    size_t cap = 0;
+    ssize_t len;
+    off_t good = 0;
+    int records = 0;
+    struct stat sb;
+
+    if (!path) return;
+    FILE *f = fopen(path, "r");
+    if (!f)
+    {
+        free(path);
+        return;
+    }
+
+    while ((len = getline(&line, &cap, f)) > 0)
+    {
+        // A record without its newline was cut short by a crash
+        if (line[len - 1] != '\n') break;
+        good += len;
+        line[len - 1] = '\0';
+
+        char *p = line;
+        char *op = _journal_field_next(&p);
+        char *key = _journal_field_next(&p);
+        if (!op || !key) continue;
+
+        FavEntry *old = eina_hash_find(ad->favorites, key);
+        if (old)
+            eina_hash_del(ad->favorites, key, old);
+        if (op[0] == '+')
+        {
+            char *uuid = _journal_field_next(&p);
+            char *url = _journal_field_next(&p);
+            char *name = _journal_field_next(&p);
+            char *favicon = _journal_field_next(&p);
+            _favorites_hash_add_entry(ad, key, uuid, url, name, favicon);
+        }
+        records++;
+    }
+    free(line);
+    fclose(f);
+
+    if (stat(path, &sb) == 0 && sb.st_size > good && truncate(path, good) == -1)
+        fprintf(stderr, "Favorites: could not truncate journal: %s\n", strerror(errno));
+    _journal_len = good;
+    free(path);
+    if (records)
+        printf("Favorites: replayed %d journal records\n", records);
+}
+
+// Drop the first len bytes of the journal, now part of favorites.xml.
+// Records appended while the file was being written stay.
+static void
+_journal_trim(off_t len)
+{
+    char *path = _favorites_journal_path();
+    if (!path) return;
+
+    if (len >= _journal_len)
+    {
+        // Everything in it is in favorites.xml, which is already synced
+        if (truncate(path, 0) == 0)
+            _journal_len = 0;
+        free(path);
+        return;
+    }
+
+    size_t tail_len = _journal_len - len;
+    size_t tmplen = strlen(path) + 5;
+    char *tail = malloc(tail_len);
+    char *tmp = malloc(tmplen);
+    int in = open(path, O_RDONLY | O_CLOEXEC);
+    int out = -1;
+
+    if (tail && tmp && in >= 0 && pread(in, tail, tail_len, len) == (ssize_t)tail_len)
+    {
+        snprintf(tmp, tmplen, "%s.tmp", path);
+        out = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    }
+    if (out >= 0)
+    {
+        // These records are not in favorites.xml yet: the new journal
+        // must be on disk before it replaces the old one
+        Eina_Bool ok = write(out, tail, tail_len) == (ssize_t)tail_len && fsync(out) == 0;
+        if (close(out) != 0) ok = EINA_FALSE;
+        if (ok && rename(tmp, path) == 0)
+        {
+            _favorites_dir_sync();
+            // Appends must go to the new file
+            if (_journal_fd >= 0) close(_journal_fd);
+            _journal_fd = -1;
+            _journal_len = tail_len;
+        }
+        else
+            unlink(tmp);
+    }
+    if (in >= 0) close(in);
+    free(tail);
+    free(tmp);
+    free(path);
+}
+
 void
 favorites_shutdown(AppData *ad)
 {
+    Station *st;
+    EINA_LIST_FREE(ad->favorites_stations, st)
+        station_free(st);
+    _stations_built = EINA_FALSE;
+
+    // Pending changes are safe in the journal and folded in on next start
+    if (_compact_timer) ecore_timer_del(_compact_timer);
+    _compact_timer = NULL;
+    if (_compact_job) _compact_job->ad = NULL;
+    _compact_job = NULL;
+    _compact_again = EINA_FALSE;
+    _compact_retry = FAVORITES_COMPACT_DELAY;
+    if (_journal_fd >= 0) close(_journal_fd);
+    _journal_fd = -1;
+    _journal_len = 0;
+
     if (!ad->favorites) return;
     eina_hash_free(ad->favorites);
     ad->favorites = NULL;
@@ -146,94 +419,281 @@ favorites_load(AppData *ad)
     xmlFreeDoc(doc);
 
 end:
+    if (ad->favorites)
+        _journal_replay(ad);
+    // Fold replayed changes into the file
+    if (_journal_len > 0)
+        favorites_save(ad);
     if (dir) free(dir);
     if (path) free(path);
 }
 
+void
+favorites_apply_to_station(AppData *ad, Station *st)
+{
+    const char *key = st->stationuuid ? st->stationuuid : st->url;
+    st->favorite = EINA_FALSE;
+    if (key && eina_hash_find(ad->favorites, key))
+        st->favorite = EINA_TRUE;
+}
+
 void
 favorites_apply_to_stations(AppData *ad)
 {
     Eina_List *l;
     Station *st;
     EINA_LIST_FOREACH(ad->stations, l, st)
-    {
-        const char *key = st->stationuuid ? st->stationuuid : st->url;
-        st->favorite = EINA_FALSE;
-        if (key && eina_hash_find(ad->favorites, key))
-            st->favorite = EINA_TRUE;
-    }
+        favorites_apply_to_station(ad, st);
 }
 
-static Eina_Bool _favorites_save_cb(const Eina_Hash *hash EINA_UNUSED, const void *key EINA_UNUSED, void *data, void *fdata)
+static void
+_station_node_add(xmlNodePtr root, const FavEntry *e)
 {
-    xmlNodePtr root = fdata;
-    FavEntry *e = data;
-    if (!e) return EINA_TRUE;
     if ((!e->uuid || !e->uuid[0]) && (!e->url || !e->url[0]))
-        return EINA_TRUE;
+        return;
     xmlNodePtr sn = xmlNewChild(root, NULL, (xmlChar *)"station", NULL);
     if (e->uuid && e->uuid[0]) xmlNewProp(sn, (xmlChar *)"uuid", (xmlChar *)e->uuid);
     if (e->name && e->name[0]) xmlNewProp(sn, (xmlChar *)"name", (xmlChar *)e->name);
     if (e->url && e->url[0]) xmlNewProp(sn, (xmlChar *)"url", (xmlChar *)e->url);
     if (e->favicon && e->favicon[0]) xmlNewProp(sn, (xmlChar *)"favicon", (xmlChar *)e->favicon);
-    return EINA_TRUE;
 }
 
-void favorites_save(AppData *ad)
+static Eina_Bool _favorites_snapshot_cb(const Eina_Hash *hash EINA_UNUSED, const void *key EINA_UNUSED, void *data, void *fdata)
 {
-    char *dir = _favorites_dir_path();
-    char *path = _favorites_file_path();
-    if (!dir || !path)
-        goto end;
+    Compact_Job *job = fdata;
+    const FavEntry *e = data;
+    FavEntry *copy = &job->entries[job->count++];
+
+    copy->uuid = e->uuid ? strdup(e->uuid) : NULL;
+    copy->url = e->url ? strdup(e->url) : NULL;
+    copy->name = e->name ? strdup(e->name) : NULL;
+    copy->favicon = e->favicon ? strdup(e->favicon) : NULL;
+    return EINA_TRUE;
+}
 
-    if (!_ensure_dir_exists(dir))
-        goto end;
+static void
+_compact_job_free(Compact_Job *job)
+{
+    for (unsigned int i = 0; i < job->count; i++)
+    {
+        free(job->entries[i].uuid);
+        free(job->entries[i].url);
+        free(job->entries[i].name);
+        free(job->entries[i].favicon);
+    }
+    free(job->entries);
+    free(job->path);
+    free(job);
+}
 
-    size_t tmplen = strlen(path) + 5;
+// Runs on a worker thread and touches only the job
+static void
+_compact_blocking(void *data, Ecore_Thread *thread EINA_UNUSED)
+{
+    Compact_Job *job = data;
+    size_t tmplen = strlen(job->path) + 5;
     char *tmp = malloc(tmplen);
-    if (!tmp) goto end;
-    snprintf(tmp, tmplen, "%s.tmp", path);
+    if (!tmp) return;
+    snprintf(tmp, tmplen, "%s.tmp", job->path);
 
     xmlDocPtr doc = xmlNewDoc((xmlChar *)"1.0");
     xmlNodePtr root = xmlNewNode(NULL, (xmlChar *)"favorites");
     xmlNewProp(root, (xmlChar *)"version", (xmlChar *)"1");
     xmlDocSetRootElement(doc, root);
 
-    eina_hash_foreach(ad->favorites, _favorites_save_cb, root);
+    for (unsigned int i = 0; i < job->count; i++)
+        _station_node_add(root, &job->entries[i]);
 
     int xml_save_result = xmlSaveFormatFileEnc(tmp, doc, "UTF-8", 1);
     xmlFreeDoc(doc);
 
     if (xml_save_result == -1) {
         // XML save failed - could be disk space, permissions, etc.
-        if (ad->statusbar) {
-            elm_object_text_set(ad->statusbar, "Error: Could not save favorites (disk full?)");
-        }
-        unlink(tmp); // Clean up the temp file
+        job->error = "Error: Could not save favorites (disk full?)";
+        unlink(tmp);
         free(tmp);
-        goto end;
+        return;
     }
 
-    if (rename(tmp, path) == -1) {
+    // The journal is trimmed after this, so the file must be on disk first
+    int fd = open(tmp, O_RDONLY | O_CLOEXEC);
+    Eina_Bool synced = fd >= 0 && fsync(fd) == 0;
+    if (fd >= 0) close(fd);
+
+    if (!synced || rename(tmp, job->path) == -1 || !_favorites_dir_sync()) {
         // Rename failed - could be filesystem issues
-        if (ad->statusbar) {
-            elm_object_text_set(ad->statusbar, "Error: Could not save favorites (filesystem error)");
-        }
-        unlink(tmp); // Clean up the temp file
+        job->error = "Error: Could not save favorites (filesystem error)";
+        unlink(tmp);
         free(tmp);
-        goto end;
+        return;
     }
 
     free(tmp);
+    job->ok = EINA_TRUE;
+}
 
-    // Success - provide feedback to user
-    if (ad->statusbar) {
-        elm_object_text_set(ad->statusbar, "Favorites saved successfully");
+static Eina_Bool _compact_timer_cb(void *data);
+
+// A failed rewrite is tried again, waiting longer each time; the journal
+// keeps every change meanwhile
+static void
+_compact_retry_schedule(AppData *ad)
+{
+    if (_compact_timer) ecore_timer_del(_compact_timer);
+    _compact_timer = ecore_timer_add(_compact_retry, _compact_timer_cb, ad);
+    _compact_retry *= 2;
+    if (_compact_retry > FAVORITES_RETRY_MAX) _compact_retry = FAVORITES_RETRY_MAX;
+}
+
+// Also the cancel callback, for a thread that could not run
+static void
+_compact_end(void *data, Ecore_Thread *thread EINA_UNUSED)
+{
+    Compact_Job *job = data;
+    AppData *ad = job->ad;
+
+    if (ad)
+    {
+        Eina_Bool again = _compact_again;
+
+        _compact_job = NULL;
+        if (job->ok)
+        {
+            _journal_trim(job->journal_len);
+            if (ad->statusbar)
+                elm_object_text_set(ad->statusbar, "Favorites saved successfully");
+        }
+        else if (ad->statusbar)
+        {
+            elm_object_text_set(ad->statusbar, job->error ? job->error : "Error: Could not save favorites");
+        }
+        _compact_again = EINA_FALSE;
+        if (job->ok)
+        {
+            _compact_retry = FAVORITES_COMPACT_DELAY;
+            if (again)
+                favorites_save(ad);
+        }
+        else
+            _compact_retry_schedule(ad);
     }
+    _compact_job_free(job);
+}
 
-end:
-    if (dir) free(dir);
-    if (path) free(path);
+static void
+_compact_start(AppData *ad)
+{
+    char *dir = _favorites_dir_path();
+    Compact_Job *job = NULL;
+    unsigned int n = eina_hash_population(ad->favorites);
+
+    if (!dir || !_ensure_dir_exists(dir)) goto fail;
+    job = calloc(1, sizeof(Compact_Job));
+    if (!job) goto fail;
+    job->ad = ad;
+    job->path = _favorites_file_path();
+    job->entries = calloc(n ? n : 1, sizeof(FavEntry));
+    if (!job->path || !job->entries)
+    {
+        _compact_job_free(job);
+        goto fail;
+    }
+    eina_hash_foreach(ad->favorites, _favorites_snapshot_cb, job);
+    job->journal_len = _journal_len;
+
+    // From here _compact_end() owns the job, unless the thread never
+    // started and did not call it either
+    _compact_job = job;
+    if (!ecore_thread_run(_compact_blocking, _compact_end, _compact_end, job) && _compact_job == job)
+    {
+        _compact_job = NULL;
+        _compact_job_free(job);
+        goto fail;
+    }
+    free(dir);
+    return;
+
+fail:
+    _compact_retry_schedule(ad);
+    free(dir);
+}
+
+static Eina_Bool
+_compact_timer_cb(void *data)
+{
+    AppData *ad = data;
+
+    _compact_timer = NULL;
+    // One rewrite at a time; the running one starts the next when done
+    if (_compact_job)
+        _compact_again = EINA_TRUE;
+    else
+        _compact_start(ad);
+    return ECORE_CALLBACK_CANCEL;
+}
+
+void favorites_save(AppData *ad)
+{
+    // Every change restarts the delay, so a burst ends in one rewrite
+    if (_compact_timer)
+        ecore_timer_reset(_compact_timer);
+    else
+        _compact_timer = ecore_timer_add(FAVORITES_COMPACT_DELAY, _compact_timer_cb, ad);
+}
+
+static Station *_station_from_entry(const FavEntry *e)
+{
+    Station *st = calloc(1, sizeof(Station));
+    if (!st) return NULL;
+    if (e->name) st->name = eina_stringshare_add(e->name);
+    if (e->url) st->url = eina_stringshare_add(e->url);
+    if (e->uuid) st->stationuuid = eina_stringshare_add(e->uuid);
+    if (e->favicon) st->favicon = eina_stringshare_add(e->favicon);
+    st->favorite = EINA_TRUE;
+    station_label_update(st);
+    return st;
+}
+
+// Give e its Station at the end of the favorites station list
+static void _entry_station_add(AppData *ad, FavEntry *e)
+{
+    Station *st = _station_from_entry(e);
+    if (!st) return;
+
+    // Add to list - check for failure to avoid memory leak
+    Eina_List *new_list = eina_list_append(ad->favorites_stations, st);
+    if (!new_list)
+    {
+        station_free(st);
+        return;
+    }
+    ad->favorites_stations = new_list;
+    e->station = st;
+    e->node = eina_list_last(new_list);
+}
+
+// Drop e's Station and its row, if it has them
+static void _entry_station_del(AppData *ad, FavEntry *e)
+{
+    if (!e->station) return;
+    station_list_station_removed(ad, e->station);
+    ad->favorites_stations = eina_list_remove_list(ad->favorites_stations, e->node);
+    station_free(e->station);
+    e->station = NULL;
+    e->node = NULL;
+}
+
+// Copy e's metadata into its Station and redraw just that row
+static void _entry_station_update(AppData *ad, FavEntry *e)
+{
+    Station *st = e->station;
+    if (!st) return;
+    eina_stringshare_replace(&st->name, e->name);
+    eina_stringshare_replace(&st->url, e->url);
+    eina_stringshare_replace(&st->stationuuid, e->uuid);
+    eina_stringshare_replace(&st->favicon, e->favicon);
+    station_label_update(st);
+    station_list_station_changed(ad, st);
 }
 
 void favorites_set(AppData *ad, Station *st, Eina_Bool on)
@@ -263,17 +723,34 @@ void favorites_set(AppData *ad, Station *st, Eina_Bool on)
                 free(existing->favicon);
                 existing->favicon = strdup(st->favicon);
             }
+            _journal_append(ad, key, existing);
+            if (existing->station != st)
+                _entry_station_update(ad, existing);
         }
         else
         {
             _favorites_hash_add_entry(ad, key, st->stationuuid, st->url, st->name, st->favicon);
+            FavEntry *added = eina_hash_find(ad->favorites, key);
+            if (added)
+                _journal_append(ad, key, added);
+            if (added && _stations_built)
+            {
+                _entry_station_add(ad, added);
+                if (added->station)
+                    station_list_favorite_added(ad, added->station);
+            }
         }
     }
     else
     {
         FavEntry *existing = eina_hash_find(ad->favorites, key);
         if (existing)
-            eina_hash_del(ad->favorites, key, existing);
+        {
+            _journal_append(ad, key, NULL);
+            // st may be the entry's own Station, and key one of its fields
+            _entry_station_del(ad, existing);
+            eina_hash_del(ad->favorites, existing->key, existing);
+        }
     }
 }
 
@@ -282,42 +759,31 @@ static Eina_Bool _favorites_rebuild_cb(const Eina_Hash *hash EINA_UNUSED, const
     AppData *ad = fdata;
     FavEntry *e = data;
     if (!ad || !e) return EINA_TRUE;
-    Station *st = calloc(1, sizeof(Station));
-    if (!st) return EINA_TRUE;
-    if (e->name) st->name = eina_stringshare_add(e->name);
-    if (e->url) st->url = eina_stringshare_add(e->url);
-    if (e->uuid) st->stationuuid = eina_stringshare_add(e->uuid);
-    if (e->favicon) st->favicon = eina_stringshare_add(e->favicon);
-    st->favorite = EINA_TRUE;
+    _entry_station_add(ad, e);
+    return EINA_TRUE;
+}
 
-    // Add to list - check for failure to avoid memory leak
-    Eina_List *new_list = eina_list_append(ad->favorites_stations, st);
-    if (!new_list)
-    {
-        // List append failed, clean up the station
-        eina_stringshare_del(st->name);
-        eina_stringshare_del(st->url);
-        eina_stringshare_del(st->stationuuid);
-        eina_stringshare_del(st->favicon);
-        free(st);
-        return EINA_TRUE;
-    }
-    ad->favorites_stations = new_list;
+static Eina_Bool _favorites_favicons_cb(const Eina_Hash *hash EINA_UNUSED, const void *key EINA_UNUSED, void *data, void *fdata)
+{
+    Eina_List **list = fdata;
+    FavEntry *e = data;
+    if (e && e->favicon && e->favicon[0])
+        *list = eina_list_append(*list, eina_stringshare_add(e->favicon));
     return EINA_TRUE;
 }
 
-void favorites_rebuild_station_list(AppData *ad)
+Eina_List *favorites_favicons_get(AppData *ad)
 {
-    Station *st;
-    EINA_LIST_FREE(ad->favorites_stations, st)
-    {
-        eina_stringshare_del(st->name);
-        eina_stringshare_del(st->url);
-        eina_stringshare_del(st->favicon);
-        eina_stringshare_del(st->stationuuid);
-        free(st);
-    }
-    ad->favorites_stations = NULL;
+    Eina_List *list = NULL;
+    if (ad && ad->favorites)
+        eina_hash_foreach(ad->favorites, _favorites_favicons_cb, &list);
+    return list;
+}
 
+void favorites_rebuild_station_list(AppData *ad)
+{
+    // Built once; favorites_set() keeps it in sync from then on
+    if (_stations_built) return;
+    _stations_built = EINA_TRUE;
     eina_hash_foreach(ad->favorites, _favorites_rebuild_cb, ad);
-}
\ No newline at end of file
+}
@@ -5,20 +5,33 @@
 // Initialize favorites storage (hash) in AppData
 void favorites_init(AppData *ad);
 
-// Load favorites from XML (~/.config/eradio/favorites.xml) into AppData
+// Load favorites from XML (~/.config/eradio/favorites.xml) and the
+// journal of later changes into AppData
 void favorites_load(AppData *ad);
 
 // Apply loaded favorites to current stations list (sets Station.favorite)
 void favorites_apply_to_stations(AppData *ad);
 
-// Save current favorites (from stations list) to XML
+// Apply loaded favorites to a single station (sets Station.favorite)
+void favorites_apply_to_station(AppData *ad, Station *st);
+
+// Schedule a rewrite of favorites.xml. favorites_set() has already
+// appended each change to ~/.config/eradio/favorites.journal; the file is
+// rewritten on a worker thread once changes have stopped for a moment,
+// and favorites_load() replays whatever the journal still holds.
 void favorites_save(AppData *ad);
 
 // Shutdown and free any favorites-related resources
 void favorites_shutdown(AppData *ad);
 
-// Update favorites hash from a station toggle (add/remove)
+// Update favorites hash from a station toggle (add/remove). Removing frees
+// the favorite's own Station, which may be st itself.
 void favorites_set(AppData *ad, Station *st, Eina_Bool on);
 
-// Rebuild an in-memory list of favorite stations from the favorites hash
-void favorites_rebuild_station_list(AppData *ad);
\ No newline at end of file
+// Build ad->favorites_stations from the favorites hash on first use.
+// After that favorites_set() adds, removes and updates single entries in
+// it and in the favorites view, so calling this again does nothing.
+void favorites_rebuild_station_list(AppData *ad);
+
+// Favicon URLs of all favorites, as a list of stringshares owned by the caller
+Eina_List *favorites_favicons_get(AppData *ad);
@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "frame_stats.h"
+
+#define FRAME_STATS_MAX_SAMPLES 8192
+#define FRAME_BUDGET (1.0 / 60.0)    // a frame slower than this was dropped
+
+static double _samples[FRAME_STATS_MAX_SAMPLES];
+static int _count = 0;
+static int _scrolling = 0;       // scroll drags and animations in progress
+static double _last = 0.0;       // time of the previous rendered frame
+static double _started = 0.0;
+
+static void
+_render_post_cb(void *data EINA_UNUSED, Evas *e EINA_UNUSED, void *event_info EINA_UNUSED)
+{
+   double now;
+
+   if (!_scrolling) return;
+   now = ecore_time_get();
+   if (_last > 0.0 && _count < FRAME_STATS_MAX_SAMPLES)
+     _samples[_count++] = now - _last;
+   _last = now;
+}
+
+static int
+_double_cmp(const void *a, const void *b)
+{
+   double da = *(const double *)a, db = *(const double *)b;
+   return (da > db) - (da < db);
+}
+
+static void
+_report(Evas_Object *list)
+{
+   double sum = 0.0;
+   int slow = 0;
+
+   if (_count < 2) return;
+   for (int i = 0; i < _count; i++)
+     {
+        sum += _samples[i];
+        if (_samples[i] > FRAME_BUDGET * 1.5) slow++;
+     }
+   qsort(_samples, _count, sizeof(double), _double_cmp);
+   printf("Frame stats: %d frames in %.2f s over %u rows: mean %.1f ms, p50 %.1f ms, "
+          "p95 %.1f ms, p99 %.1f ms, max %.1f ms, %d over budget\n",
+          _count, ecore_time_get() - _started, elm_genlist_items_count(list),
+          sum / _count * 1000.0,
+          _samples[_count / 2] * 1000.0,
+          _samples[_count * 95 / 100] * 1000.0,
+          _samples[_count * 99 / 100] * 1000.0,
+          _samples[_count - 1] * 1000.0, slow);
+}
+
+static void
+_scroll_start_cb(void *data EINA_UNUSED, Evas_Object *obj EINA_UNUSED, void *event_info EINA_UNUSED)
+{
+   if (_scrolling++) return;
+   _count = 0;
+   _last = 0.0;
+   _started = ecore_time_get();
+}
+
+static void
+_scroll_stop_cb(void *data EINA_UNUSED, Evas_Object *obj, void *event_info EINA_UNUSED)
+{
+   if (!_scrolling || --_scrolling) return;
+   _report(obj);
+}
+
+void
+frame_stats_attach(Evas_Object *list)
+{
+   const char *env = getenv("ERADIO_FRAME_STATS");
+
+   if (!env || !env[0] || !strcmp(env, "0")) return;
+
+   evas_event_callback_add(evas_object_evas_get(list), EVAS_CALLBACK_RENDER_POST, _render_post_cb, NULL);
+   evas_object_smart_callback_add(list, "scroll,drag,start", _scroll_start_cb, NULL);
+   evas_object_smart_callback_add(list, "scroll,drag,stop", _scroll_stop_cb, NULL);
+   evas_object_smart_callback_add(list, "scroll,anim,start", _scroll_start_cb, NULL);
+   evas_object_smart_callback_add(list, "scroll,anim,stop", _scroll_stop_cb, NULL);
+   printf("Frame stats enabled\n");
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <Elementary.h>
+
+// Scroll frame-time instrumentation, enabled with ERADIO_FRAME_STATS=1.
+// Frame intervals are recorded from the canvas' render events while the
+// list scrolls, and summarized on stdout when the scroll ends.
+
+void frame_stats_attach(Evas_Object *list);
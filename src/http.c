@@ -1,17 +1,39 @@
 #include <Ecore_Con.h>
-#include <libxml/parser.h>
-#include <libxml/xpath.h>
-#include <netdb.h>
-#include <sys/socket.h>
-#include <arpa/inet.h>
 #include <time.h>
 #include <string.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <Ecore_File.h>
 
 #include "http.h"
 #include "station_list.h"
 #include "favorites.h"
-#include "ui.h" // Include ui.h for ui_set_load_more_button_visibility
+#include "station_parser.h"
+#include "search_cache.h"
+#include "result_cache.h"
+#include "server_stats.h"
+#include "server_discovery.h"
+#include "ui.h" // Include ui.h for ui_loading_start/ui_loading_stop
+
+// Stations requested per page; the next page is fetched when the row
+// STATION_PREFETCH_ROWS from the end of the list is realized.
+#define STATION_PAGE_SIZE 100
+#define STATION_PREFETCH_ROWS 30
+
+// Hedged searches: a second mirror is asked when the first has not sent a
+// byte after the 95th percentile of recent time-to-first-byte samples
+#define HEDGE_TTFB_SAMPLES 32
+#define HEDGE_DEFAULT_DELAY 1.0
+#define HEDGE_MIN_DELAY 0.25
+#define HEDGE_MAX_DELAY 3.0
+
+// Search-as-you-type waits for a pause in typing before searching
+#define SEARCH_DEBOUNCE_DELAY 0.4
+#define SEARCH_MIN_TERM_LENGTH 2
+
+// A favicon host that has not finished within this many seconds is given up
+#define ICON_TIMEOUT 15.0
 
 typedef enum _Download_Type
 {
@@ -29,7 +51,11 @@ typedef struct _Download_Context
 typedef struct _Station_Download_Context
 {
    Download_Context base;
-   xmlParserCtxtPtr ctxt;
+   Station_Parser *parser;
+   ApiFormat format;
+   Eina_Bool replaced;     // previous results already dropped for this search
+   int bytes;              // response bytes received from the current server
+   double parse_time;      // seconds spent feeding the parser
    Eina_List *servers;     // list of const char* hostnames
    Eina_List *current;     // current server node
    char search_type[64];
@@ -38,14 +64,30 @@ typedef struct _Station_Download_Context
    Eina_Bool reverse;
    int offset;
    int limit;
+   int delivered;          // stations received so far, across fallbacks
    Eina_Bool new_search;
+   Eina_Binbuf *body;      // raw response, stored in the search cache on success
+   Eina_Bool resumed;      // fallback continued a partial page; not cacheable
+   Eina_Bool revalidate;   // background conditional refresh of a cached page
+   unsigned int generation; // ad->search_generation when issued
+   Ecore_Con_Url *url;     // request in flight for the current server
+   double started;         // when url was issued
+   Eina_Bool first_byte;   // url has started answering
+   Ecore_Timer *hedge_timer;
+   Eina_Bool hedged;       // already raced against, or is, a hedge request
+   struct _Station_Download_Context *peer;   // twin racing on another mirror
 } Station_Download_Context;
 
 typedef struct _Icon_Download_Context
 {
    Download_Context base;
-   Elm_Object_Item *list_item;
-   Eina_Binbuf *image_data;
+   int fd;                 // body is written here by Ecore_Con, -1 once closed
+   char *path;             // where the icon goes on success
+   char *tmp_path;         // path + ".tmp", renamed over path when complete
+   size_t max_size;        // larger bodies are abandoned
+   Http_Icon_Done_Cb done_cb;
+   void *data;
+   Ecore_Job *abort_job;   // pending abort of an oversized download
 } Icon_Download_Context;
 
 typedef struct _Counter_Download_Context
@@ -53,33 +95,44 @@ typedef struct _Counter_Download_Context
    Download_Context base;
    Eina_List *servers;     // list of const char* hostnames
    Eina_List *current;     // current server node
+   double started;         // when the request to current was issued
+   double ttfb;            // seconds to the first data event, < 0 until then
    char stationuuid[128];
 } Counter_Download_Context;
 
-// Helper function to clean up a Station structure
-static void _station_free(Station *st)
+static Eina_List *_station_requests = NULL;   // every live Station_Download_Context
+static Ecore_Timer *_search_debounce_timer = NULL;
+
+// Result set being replaced by a diffing refresh of the list
+static struct
 {
-    if (!st) return;
-    eina_stringshare_del(st->name);
-    eina_stringshare_del(st->url);
-    eina_stringshare_del(st->favicon);
-    eina_stringshare_del(st->stationuuid);
-    eina_stringshare_del(st->country);
-    eina_stringshare_del(st->language);
-    eina_stringshare_del(st->codec);
-    eina_stringshare_del(st->tags);
-    free(st);
-}
+    AppData *ad;                        // NULL: no refresh in progress
+    Station_Download_Context *owner;    // request whose end finishes it
+    Eina_List *stations;
+    const char *key;
+    int offset;
+    Eina_Bool has_more;
+} _stash;
+
+static double _ttfb_samples[HEDGE_TTFB_SAMPLES];
+static int _ttfb_count = 0;
+static int _ttfb_next = 0;
 
 static Eina_Bool _url_data_cb(void *data, int type, void *event_info);
 static Eina_Bool _url_complete_cb(void *data, int type, void *event_info);
+static Eina_Bool _url_progress_cb(void *data, int type, void *event_info);
 
-static void _refresh_api_servers(AppData *ad);
-static void _randomize_servers(AppData *ad);
-static const char *_primary_server(AppData *ad);
 static void _populate_station_request(Station_Download_Context *d_ctx, AppData *ad, const char *search_type, const char *search_term, const char *order, Eina_Bool reverse);
 static void _issue_station_request(Ecore_Con_Url **url_out, Station_Download_Context *d_ctx);
 static void _retry_next_server_station(Ecore_Con_Url *old_url, Station_Download_Context *d_ctx);
+static Eina_Bool _serve_from_cache(Station_Download_Context *d_ctx, Search_Cache_Entry **entry_out);
+static Eina_Bool _restore_from_result_cache(Station_Download_Context *d_ctx);
+static void _station_request_free(Station_Download_Context *d_ctx);
+static void _refresh_finish(void);
+static void _stash_release(void);
+static void _hedge_arm(Station_Download_Context *d_ctx);
+static void _station_request_cancel(Station_Download_Context *d_ctx);
+static void _supersede_station_requests(AppData *ad);
 static void _populate_counter_request(Counter_Download_Context *c_ctx, AppData *ad, const char *uuid);
 static void _issue_counter_request(Ecore_Con_Url **url_out, Counter_Download_Context *c_ctx);
 static void _retry_next_server_counter(Ecore_Con_Url *old_url, Counter_Download_Context *c_ctx);
@@ -90,15 +143,48 @@ http_init(AppData *ad)
    ecore_con_init();
    ecore_event_handler_add(ECORE_CON_EVENT_URL_DATA, _url_data_cb, ad);
    ecore_event_handler_add(ECORE_CON_EVENT_URL_COMPLETE, _url_complete_cb, ad);
+   ecore_event_handler_add(ECORE_CON_EVENT_URL_PROGRESS, _url_progress_cb, ad);
+
+   // ERADIO_API_FORMAT=json switches searches to the smaller JSON endpoint
+   const char *format = getenv("ERADIO_API_FORMAT");
+   ad->api_format = (format && !strcasecmp(format, "json")) ? API_FORMAT_JSON : API_FORMAT_XML;
+
+   // ERADIO_HEDGE=1 races a second mirror when the first is slow to answer
+   const char *hedge = getenv("ERADIO_HEDGE");
+   ad->hedge_requests = (hedge && hedge[0] && strcmp(hedge, "0") != 0);
+
+   // Servers are ranked by measured latency and reliability; api_selected
+   // stays NULL (automatic) unless the user picks one
+   srand(time(NULL));
+   server_stats_load();
+   ad->api_selected = NULL;
+
+   // Start from the servers known last run; discovery runs in the background
+   server_discovery_start(ad);
+}
+
+static void
+_result_cache_summary(void)
+{
+   unsigned int hits, misses, sets;
+   size_t bytes;
 
-   _refresh_api_servers(ad);
-   _randomize_servers(ad);
-   ad->api_selected = _primary_server(ad);
+   result_cache_stats_get(&hits, &misses, &sets, &bytes);
+   printf("Result cache: %u hits, %u misses; %u sets (%zu bytes) held at exit\n",
+          hits, misses, sets, bytes);
 }
 
 void
 http_shutdown(void)
 {
+   if (_search_debounce_timer) ecore_timer_del(_search_debounce_timer);
+   _search_debounce_timer = NULL;
+   server_discovery_shutdown();
+   // The window and its list are gone by now; only the parked set is left
+   _stash_release();
+   _result_cache_summary();
+   result_cache_shutdown();
+   server_stats_shutdown();
    ecore_con_shutdown();
 }
 
@@ -107,19 +193,77 @@ http_search_stations(AppData *ad, const char *search_term, const char *search_ty
 {
    Ecore_Con_Url *url;
    Station_Download_Context *d_ctx;
+   Search_Cache_Entry *cached = NULL;
 
    if (!search_term || !search_term[0]) return;
 
+   if (new_search)
+     {
+        _supersede_station_requests(ad);
+        // Rows of the old results still waiting to be inserted are dropped.
+        // In the favorites view the queue holds favorites, which stay.
+        if (ad->view_mode == VIEW_SEARCH)
+          station_list_populate_cancel(ad);
+     }
+
+   // Paging state of the shown results is kept until they are replaced,
+   // so they can be stashed in the result cache as they are
+   if (new_search)
+     {
+        eina_stringshare_replace(&ad->search_term, search_term);
+        eina_stringshare_replace(&ad->search_type, search_type);
+        eina_stringshare_replace(&ad->search_order, order);
+        ad->search_reverse = reverse;
+     }
+
    d_ctx = calloc(1, sizeof(Station_Download_Context));
    d_ctx->base.type = DOWNLOAD_TYPE_STATIONS;
    d_ctx->base.ad = ad;
    d_ctx->new_search = new_search;
+   d_ctx->generation = ad->search_generation;
+   _station_requests = eina_list_append(_station_requests, d_ctx);
+   d_ctx->offset = new_search ? 0 : ad->search_offset;
+   d_ctx->limit = STATION_PAGE_SIZE;
+   d_ctx->format = ad->api_format;
    _populate_station_request(d_ctx, ad, search_type, search_term, order, reverse);
+
+   // Re-running a recent query restores its parsed result set as it was
+   if (new_search && _restore_from_result_cache(d_ctx))
+     {
+        _station_request_free(d_ctx);
+        return;
+     }
+
+   // A fresh cache hit needs no network at all; a stale one is shown right
+   // away and revalidated in the background
+   if (_serve_from_cache(d_ctx, &cached))
+     return;
+
    _issue_station_request(&url, d_ctx);
    ecore_con_url_additional_header_add(url, "User-Agent", "eradio/1.0");
+   if (cached)
+     {
+        if (cached->etag[0])
+          ecore_con_url_additional_header_add(url, "If-None-Match", cached->etag);
+        if (cached->last_modified[0])
+          ecore_con_url_additional_header_add(url, "If-Modified-Since", cached->last_modified);
+        search_cache_entry_free(cached);
+     }
+   else
+     {
+        ad->search_page_pending = EINA_TRUE;
+        ui_loading_start(ad);
+     }
    ecore_con_url_data_set(url, d_ctx);
-   ui_loading_start(ad);
    ecore_con_url_get(url);
+   _hedge_arm(d_ctx);
+}
+
+void
+http_search_stations_next_page(AppData *ad)
+{
+   if (!ad->search_has_more || ad->search_page_pending) return;
+   http_search_stations(ad, ad->search_term, ad->search_type, ad->search_order, ad->search_reverse, EINA_FALSE);
 }
 
 void
@@ -140,17 +284,78 @@ http_station_click_counter(AppData *ad, const char *uuid)
    ecore_con_url_get(url);
 }
 
-void
-http_download_icon(AppData *ad, Elm_Object_Item *list_item, const char *url_str)
+static void
+_icon_request_free(Icon_Download_Context *icon_ctx)
+{
+    if (icon_ctx->abort_job) ecore_job_del(icon_ctx->abort_job);
+    if (icon_ctx->fd != -1)
+      {
+         close(icon_ctx->fd);
+         unlink(icon_ctx->tmp_path);
+      }
+    free(icon_ctx->path);
+    free(icon_ctx->tmp_path);
+    free(icon_ctx);
+}
+
+Ecore_Con_Url *
+http_download_icon(AppData *ad, const char *url_str, const char *path, size_t max_size, Http_Icon_Done_Cb done_cb, const void *data)
 {
     Ecore_Con_Url *url = ecore_con_url_new(url_str);
-    Icon_Download_Context *icon_ctx = calloc(1, sizeof(Icon_Download_Context));
+    Icon_Download_Context *icon_ctx;
+
+    if (!url) return NULL;
+    icon_ctx = calloc(1, sizeof(Icon_Download_Context));
+    if (!icon_ctx)
+      {
+         ecore_con_url_free(url);
+         return NULL;
+      }
     icon_ctx->base.type = DOWNLOAD_TYPE_ICON;
     icon_ctx->base.ad = ad;
-    icon_ctx->list_item = list_item;
+    icon_ctx->max_size = max_size;
+    icon_ctx->done_cb = done_cb;
+    icon_ctx->data = (void *)data;
+    icon_ctx->path = strdup(path);
+    icon_ctx->tmp_path = malloc(strlen(path) + sizeof(".tmp"));
+    icon_ctx->fd = -1;
+    if (icon_ctx->path && icon_ctx->tmp_path)
+      {
+         sprintf(icon_ctx->tmp_path, "%s.tmp", path);
+         icon_ctx->fd = open(icon_ctx->tmp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+      }
+    if (icon_ctx->fd == -1)
+      {
+         _icon_request_free(icon_ctx);
+         ecore_con_url_free(url);
+         return NULL;
+      }
+
+    // The body goes straight from the socket into the file; there are no
+    // data events and no copy in memory
+    ecore_con_url_fd_set(url, icon_ctx->fd);
+    ecore_con_url_additional_header_add(url, "User-Agent", "eradio/1.0");
+    ecore_con_url_timeout_set(url, ICON_TIMEOUT);
     ecore_con_url_data_set(url, icon_ctx);
-    ui_loading_start(ad);
-    ecore_con_url_get(url);
+    if (!ecore_con_url_get(url))
+      {
+         _icon_request_free(icon_ctx);
+         ecore_con_url_free(url);
+         return NULL;
+      }
+    return url;
+}
+
+void
+http_download_icon_cancel(Ecore_Con_Url *url)
+{
+    Icon_Download_Context *icon_ctx;
+
+    if (!url) return;
+    icon_ctx = ecore_con_url_data_get(url);
+    ecore_con_url_data_set(url, NULL);
+    ecore_con_url_free(url);
+    if (icon_ctx) _icon_request_free(icon_ctx);
 }
 
 void
@@ -161,7 +366,13 @@ _search_btn_clicked_cb(void *data, Evas_Object *obj EINA_UNUSED, void *event_inf
    const char *search_type = elm_object_text_get(ad->search_hoversel);
    const char *order = elm_object_text_get(ad->sort_hoversel);
    Eina_Bool reverse = elm_check_state_get(ad->reverse_check);
-   ad->search_offset = 0; // Reset offset for a new search
+
+   // An explicit search overtakes one waiting for a typing pause
+   if (_search_debounce_timer)
+     {
+        ecore_timer_del(_search_debounce_timer);
+        _search_debounce_timer = NULL;
+     }
    http_search_stations(ad, search_term, search_type, order, reverse, EINA_TRUE);
 }
 
@@ -171,6 +382,295 @@ _search_entry_activated_cb(void *data, Evas_Object *obj EINA_UNUSED, void *event
    _search_btn_clicked_cb(data, obj, event_info);
 }
 
+static Eina_Bool
+_search_debounce_cb(void *data)
+{
+   AppData *ad = data;
+   const char *search_term = elm_object_text_get(ad->search_entry);
+   const char *search_type = elm_object_text_get(ad->search_hoversel);
+   const char *order = elm_object_text_get(ad->sort_hoversel);
+   Eina_Bool reverse = elm_check_state_get(ad->reverse_check);
+
+   _search_debounce_timer = NULL;
+   if (!search_term || strlen(search_term) < SEARCH_MIN_TERM_LENGTH)
+     return ECORE_CALLBACK_CANCEL;
+
+   // Typing back to the query already shown needs no request
+   if (ad->search_term && !strcmp(ad->search_term, search_term) &&
+       ad->search_type && !strcmp(ad->search_type, search_type) &&
+       ad->search_order && !strcmp(ad->search_order, order) &&
+       ad->search_reverse == reverse)
+     return ECORE_CALLBACK_CANCEL;
+
+   http_search_stations(ad, search_term, search_type, order, reverse, EINA_TRUE);
+   return ECORE_CALLBACK_CANCEL;
+}
+
+void
+_search_entry_changed_cb(void *data, Evas_Object *obj EINA_UNUSED, void *event_info EINA_UNUSED)
+{
+   AppData *ad = data;
+
+   if (!elm_check_state_get(ad->instant_search_check)) return;
+
+   // Restart the delay on every keystroke so one request goes out per pause
+   if (_search_debounce_timer)
+     ecore_timer_reset(_search_debounce_timer);
+   else
+     _search_debounce_timer = ecore_timer_add(SEARCH_DEBOUNCE_DELAY, _search_debounce_cb, ad);
+}
+
+// Copy the value of response header name into buf, without surrounding
+// whitespace. Returns EINA_FALSE if the header is absent.
+static Eina_Bool
+_response_header_get(Ecore_Con_Url *url, const char *name, char *buf, size_t len)
+{
+    const Eina_List *headers = ecore_con_url_response_headers_get(url);
+    const Eina_List *l;
+    const char *line;
+    size_t name_len = strlen(name);
+
+    EINA_LIST_FOREACH(headers, l, line)
+    {
+        if (strncasecmp(line, name, name_len) != 0 || line[name_len] != ':')
+          continue;
+
+        const char *value = line + name_len + 1;
+        while (*value == ' ' || *value == '\t') value++;
+        size_t n = strcspn(value, "\r\n");
+        if (n >= len) n = len - 1;
+        memcpy(buf, value, n);
+        buf[n] = '\0';
+        return EINA_TRUE;
+    }
+    return EINA_FALSE;
+}
+
+static void
+_station_cache_key(Station_Download_Context *d_ctx, char *buf, size_t len)
+{
+    search_cache_key_build(buf, len, d_ctx->format, d_ctx->search_type,
+                           d_ctx->search_term, d_ctx->order, d_ctx->reverse,
+                           d_ctx->offset, d_ctx->limit);
+}
+
+static void
+_station_request_free(Station_Download_Context *d_ctx)
+{
+    if (_stash.owner == d_ctx) _refresh_finish();
+    _station_requests = eina_list_remove(_station_requests, d_ctx);
+    if (d_ctx->hedge_timer) ecore_timer_del(d_ctx->hedge_timer);
+    if (d_ctx->peer) d_ctx->peer->peer = NULL;
+    station_parser_free(d_ctx->parser);
+    if (d_ctx->body) eina_binbuf_free(d_ctx->body);
+    eina_list_free(d_ctx->servers);
+    free(d_ctx);
+}
+
+// Key of a whole result set in the in-memory result cache: the query
+// without page
+static void
+_result_set_key(Station_Download_Context *d_ctx, char *buf, size_t len)
+{
+    search_cache_key_build(buf, len, d_ctx->format, d_ctx->search_type,
+                           d_ctx->search_term, d_ctx->order, d_ctx->reverse, 0, 0);
+}
+
+// The list diffs the new results against the rows still showing the old
+// set, so the old set only goes to the result cache once the request that
+// replaced it is over and its leftover rows are gone
+static void
+_refresh_finish(void)
+{
+    if (!_stash.ad) return;
+    station_list_refresh_end(_stash.ad);
+    _stash_release();
+}
+
+static void
+_stash_release(void)
+{
+    if (!_stash.ad) return;
+    result_cache_put(_stash.key, _stash.stations, _stash.offset, _stash.has_more);
+    eina_stringshare_del(_stash.key);
+    memset(&_stash, 0, sizeof(_stash));
+}
+
+// Take the shown result set off the list and park it in the result cache
+static void
+_stash_shown_results(Station_Download_Context *d_ctx)
+{
+    AppData *ad = d_ctx->base.ad;
+    char key[1024];
+
+    _refresh_finish();
+    if (ad->view_mode == VIEW_SEARCH)
+      station_list_refresh_begin(ad);
+    ad->prefetch_trigger = NULL;
+    _stash.ad = ad;
+    _stash.owner = d_ctx;
+    _stash.stations = ad->stations;
+    _stash.key = eina_stringshare_ref(ad->stations_key);
+    _stash.offset = ad->search_offset;
+    _stash.has_more = ad->search_has_more;
+    ad->stations = NULL;
+
+    _result_set_key(d_ctx, key, sizeof(key));
+    eina_stringshare_replace(&ad->stations_key, key);
+}
+
+// Abort a request whose results are no longer wanted
+static void
+_station_request_cancel(Station_Download_Context *d_ctx)
+{
+    AppData *ad = d_ctx->base.ad;
+    Eina_Bool background = d_ctx->revalidate;
+
+    if (d_ctx->url)
+      {
+         ecore_con_url_data_set(d_ctx->url, NULL);
+         ecore_con_url_free(d_ctx->url);
+         d_ctx->url = NULL;
+      }
+    _station_request_free(d_ctx);
+    if (!background)
+      ui_loading_stop(ad);
+}
+
+// Start a new search generation and cancel every request of older ones.
+// Background revalidations only refresh the disk cache and are left alone.
+static void
+_supersede_station_requests(AppData *ad)
+{
+    Eina_List *l, *l_next;
+    Station_Download_Context *d_ctx;
+
+    ad->search_generation++;
+    EINA_LIST_FOREACH_SAFE(_station_requests, l, l_next, d_ctx)
+      {
+         if (d_ctx->revalidate) continue;
+         // Rows of a partly delivered page stay shown; record where they
+         // end so the set can be continued if it is restored later
+         if (d_ctx->delivered > 0)
+           {
+              ad->search_offset = d_ctx->offset + d_ctx->delivered;
+              ad->search_has_more = EINA_TRUE;
+           }
+         printf("Cancelling superseded search request (%d stations delivered)\n", d_ctx->delivered);
+         _station_request_cancel(d_ctx);
+      }
+    ad->search_page_pending = EINA_FALSE;
+}
+
+static void
+_ttfb_sample_add(double ttfb)
+{
+    _ttfb_samples[_ttfb_next] = ttfb;
+    _ttfb_next = (_ttfb_next + 1) % HEDGE_TTFB_SAMPLES;
+    if (_ttfb_count < HEDGE_TTFB_SAMPLES) _ttfb_count++;
+}
+
+static int
+_double_cmp(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double
+_hedge_delay_get(void)
+{
+    double sorted[HEDGE_TTFB_SAMPLES];
+    double delay;
+
+    if (_ttfb_count < 5) return HEDGE_DEFAULT_DELAY;
+
+    memcpy(sorted, _ttfb_samples, _ttfb_count * sizeof(double));
+    qsort(sorted, _ttfb_count, sizeof(double), _double_cmp);
+    delay = sorted[(_ttfb_count * 95 + 99) / 100 - 1];
+    if (delay < HEDGE_MIN_DELAY) delay = HEDGE_MIN_DELAY;
+    if (delay > HEDGE_MAX_DELAY) delay = HEDGE_MAX_DELAY;
+    return delay;
+}
+
+static Eina_Bool
+_hedge_timer_cb(void *data)
+{
+    Station_Download_Context *d_ctx = data;
+    AppData *ad = d_ctx->base.ad;
+    Station_Download_Context *peer;
+    Ecore_Con_Url *url;
+
+    d_ctx->hedge_timer = NULL;
+    if (d_ctx->first_byte || d_ctx->peer || !d_ctx->current || !d_ctx->current->next)
+      return ECORE_CALLBACK_CANCEL;
+
+    peer = calloc(1, sizeof(Station_Download_Context));
+    if (!peer) return ECORE_CALLBACK_CANCEL;
+    *peer = *d_ctx;
+    peer->parser = NULL;
+    peer->body = NULL;
+    peer->url = NULL;
+    peer->hedge_timer = NULL;
+    peer->servers = eina_list_clone(d_ctx->servers);
+    peer->current = eina_list_nth_list(peer->servers, eina_list_count(d_ctx->servers) - eina_list_count(d_ctx->current) + 1);
+    peer->hedged = EINA_TRUE;
+    peer->peer = d_ctx;
+    _station_requests = eina_list_append(_station_requests, peer);
+    d_ctx->peer = peer;
+    d_ctx->hedged = EINA_TRUE;
+
+    printf("No response after %.2fs, hedging with %s\n", ecore_time_get() - d_ctx->started,
+           (const char *)eina_list_data_get(peer->current));
+    _issue_station_request(&url, peer);
+    ecore_con_url_additional_header_add(url, "User-Agent", "eradio/1.0");
+    ecore_con_url_data_set(url, peer);
+    ui_loading_start(ad);
+    ecore_con_url_get(url);
+    return ECORE_CALLBACK_CANCEL;
+}
+
+// Schedule a hedge request if the current server stays silent too long
+static void
+_hedge_arm(Station_Download_Context *d_ctx)
+{
+    AppData *ad = d_ctx->base.ad;
+
+    if (!ad->hedge_requests || d_ctx->revalidate || d_ctx->hedged) return;
+    if (!d_ctx->current || !d_ctx->current->next) return;
+    d_ctx->hedge_timer = ecore_timer_add(_hedge_delay_get(), _hedge_timer_cb, d_ctx);
+}
+
+// Drop the previous result set the first time a new search has something
+// to show (or finishes empty), so old rows stay visible until then.
+static void
+_replace_previous_results(Station_Download_Context *d_ctx)
+{
+    if (!d_ctx->new_search || d_ctx->replaced) return;
+    d_ctx->replaced = EINA_TRUE;
+    _stash_shown_results(d_ctx);
+}
+
+static void
+_station_batch_cb(void *data, Eina_List *batch)
+{
+    Station_Download_Context *d_ctx = data;
+    AppData *ad = d_ctx->base.ad;
+    Eina_List *l;
+    Station *st;
+
+    _replace_previous_results(d_ctx);
+
+    EINA_LIST_FOREACH(batch, l, st)
+      favorites_apply_to_station(ad, st);
+    d_ctx->delivered += eina_list_count(batch);
+
+    // batch keeps pointing at its first node once merged into ad->stations
+    ad->stations = eina_list_merge(ad->stations, batch);
+    if (ad->view_mode == VIEW_SEARCH)
+      station_list_append(ad, batch);
+}
+
 static void
 _handle_station_list_data(Ecore_Con_Event_Url_Data *url_data)
 {
@@ -178,101 +678,259 @@ _handle_station_list_data(Ecore_Con_Event_Url_Data *url_data)
 
     if (!d_ctx) return;
 
-    if (!d_ctx->ctxt)
+    // Error bodies are not station lists; the complete handler retries them
+    if (ecore_con_url_status_code_get(url_data->url_con) != 200) return;
+
+    // Data of a superseded search is dropped before it is parsed
+    if (!d_ctx->revalidate && d_ctx->generation != d_ctx->base.ad->search_generation) return;
+
+    if (!d_ctx->first_byte)
       {
-         d_ctx->ctxt = xmlCreatePushParserCtxt(NULL, NULL,
-                                               (const char *)url_data->data, url_data->size,
-                                               "noname.xml");
+         double ttfb = ecore_time_get() - d_ctx->started;
+
+         d_ctx->first_byte = EINA_TRUE;
+         _ttfb_sample_add(ttfb);
+         server_stats_success(eina_list_data_get(d_ctx->current), ttfb);
+         if (d_ctx->hedge_timer)
+           {
+              ecore_timer_del(d_ctx->hedge_timer);
+              d_ctx->hedge_timer = NULL;
+           }
+         // First mirror to answer wins the race; the other is cancelled
+         if (d_ctx->peer)
+           {
+              printf("Hedged search answered first by %s\n", (const char *)eina_list_data_get(d_ctx->current));
+              _station_request_cancel(d_ctx->peer);
+           }
       }
-    else
-      xmlParseChunk(d_ctx->ctxt, (const char *)url_data->data, url_data->size, 0);
+
+    if (!d_ctx->resumed)
+      {
+         if (!d_ctx->body) d_ctx->body = eina_binbuf_new();
+         eina_binbuf_append_length(d_ctx->body, (const unsigned char *)url_data->data, url_data->size);
+      }
+
+    // A revalidation only refreshes the cache; the page is already shown
+    if (d_ctx->revalidate) return;
+
+    if (!d_ctx->parser)
+      d_ctx->parser = station_parser_new(d_ctx->format, _station_batch_cb, d_ctx);
+
+    double start = ecore_time_get();
+    station_parser_feed(d_ctx->parser, (const char *)url_data->data, url_data->size);
+    d_ctx->parse_time += ecore_time_get() - start;
+    d_ctx->bytes += url_data->size;
 }
 
+// An icon over its size cap is dropped from inside its own progress event,
+// so the transfer itself is torn down from a job once the event is handled
 static void
-_handle_icon_data(Ecore_Con_Event_Url_Data *url_data)
+_icon_abort_job_cb(void *data)
 {
-    Icon_Download_Context *icon_ctx = ecore_con_url_data_get(url_data->url_con);
+    Ecore_Con_Url *url = data;
+    Icon_Download_Context *icon_ctx = ecore_con_url_data_get(url);
+    Http_Icon_Done_Cb done_cb = icon_ctx->done_cb;
+    void *cb_data = icon_ctx->data;
+    int status = ecore_con_url_status_code_get(url);
+
+    icon_ctx->abort_job = NULL;
+    http_download_icon_cancel(url);
+    done_cb(cb_data, NULL, 0, status, NULL);
+}
 
-    if (!icon_ctx) return;
+// The advertised length is checked as soon as it is known, the received
+// length as it grows
+static void
+_handle_icon_progress(Ecore_Con_Event_Url_Progress *ev)
+{
+    Icon_Download_Context *icon_ctx = ecore_con_url_data_get(ev->url_con);
 
-    if (!icon_ctx->image_data)
-      icon_ctx->image_data = eina_binbuf_new();
+    if (!icon_ctx || icon_ctx->abort_job) return;
+    if (ev->down.total <= icon_ctx->max_size && ev->down.now <= icon_ctx->max_size) return;
 
-    eina_binbuf_append_length(icon_ctx->image_data, (const unsigned char *)url_data->data, url_data->size);
+    printf("Favicon %s exceeds %zu bytes; abandoning it\n",
+           ecore_con_url_url_get(ev->url_con), icon_ctx->max_size);
+    icon_ctx->abort_job = ecore_job_add(_icon_abort_job_cb, ev->url_con);
 }
 
 static void
 _handle_icon_complete(Ecore_Con_Event_Url_Complete *ev)
 {
     Icon_Download_Context *icon_ctx = ecore_con_url_data_get(ev->url_con);
+    char content_type[128] = "";
+    struct stat st;
+    Eina_Bool ok, stored;
 
-    if (icon_ctx && icon_ctx->image_data && ev->status == 200)
-    {
-        const Eina_List *headers;
-        const char *content_type = NULL;
-        void *header_data;
+    if (!icon_ctx) return;
+    ecore_con_url_data_set(ev->url_con, NULL);
 
-        headers = ecore_con_url_response_headers_get(ev->url_con);
-        EINA_LIST_FOREACH(headers, headers, header_data)
-        {
-            const char *header_line = header_data;
-            if (strncasecmp(header_line, "Content-Type:", 13) == 0)
-            {
-                content_type = header_line + 13;
-                while (*content_type == ' ') content_type++;
-                break;
-            }
-        }
+    // An oversized body is reported as a failure even if it did complete.
+    // The file only appears under its real name once it is whole.
+    ok = !icon_ctx->abort_job && ev->status == 200 &&
+         fstat(icon_ctx->fd, &st) == 0 && st.st_size > 0 && (size_t)st.st_size <= icon_ctx->max_size;
+    stored = close(icon_ctx->fd) == 0;
+    icon_ctx->fd = -1;
+    if (ok && stored && rename(icon_ctx->tmp_path, icon_ctx->path) == -1) stored = EINA_FALSE;
 
-        if (content_type && strncasecmp(content_type, "image/", 6) == 0)
-        {
-            Elm_Object_Item *it = icon_ctx->list_item;
-            Station *st = elm_object_item_data_get(it);
-            Evas_Object *icon = elm_object_item_part_content_get(it, "start");
-            const char *ext = strrchr(ecore_con_url_url_get(ev->url_con), '.');
-            if (ext) ext++;
-
-            if (st && st->stationuuid)
-            {
-                char cache_dir[PATH_MAX];
-                const char *home = getenv("HOME");
-                snprintf(cache_dir, sizeof(cache_dir), "%s/.cache/eradio/favicons", home);
-                ecore_file_mkpath(cache_dir);
-
-                char cache_path[PATH_MAX];
-                snprintf(cache_path, sizeof(cache_path), "%s/%s", cache_dir, st->stationuuid);
-
-                FILE *f = fopen(cache_path, "wb");
-                if (f)
-                {
-                    fwrite(eina_binbuf_string_get(icon_ctx->image_data), 1, eina_binbuf_length_get(icon_ctx->image_data), f);
-                    fclose(f);
-                }
-            }
-
-            elm_image_memfile_set(icon, eina_binbuf_string_get(icon_ctx->image_data), eina_binbuf_length_get(icon_ctx->image_data), (char *)ext, NULL);
-        }
-    }
+    if (!ok || !stored)
+      {
+         unlink(icon_ctx->tmp_path);
+         // Failing to store a good response is our fault, not the server's
+         icon_ctx->done_cb(icon_ctx->data, NULL, 0, ok ? HTTP_ICON_LOCAL_ERROR : ev->status, NULL);
+      }
+    else
+      {
+         _response_header_get(ev->url_con, "Content-Type", content_type, sizeof(content_type));
+         icon_ctx->done_cb(icon_ctx->data, icon_ctx->path, st.st_size, ev->status, content_type);
+      }
+    _icon_request_free(icon_ctx);
+}
 
-    if (icon_ctx)
-    {
-       if (icon_ctx->image_data) eina_binbuf_free(icon_ctx->image_data);
-       free(icon_ctx);
-    }
+// Place the prefetch trigger STATION_PREFETCH_ROWS rows before the end of
+// the results, so the next page arrives before the user scrolls to it.
+static void
+_update_prefetch_trigger(AppData *ad)
+{
+    Eina_List *l = eina_list_last(ad->stations);
+
+    for (int i = 1; l && eina_list_prev(l) && i < STATION_PREFETCH_ROWS; i++)
+      l = eina_list_prev(l);
+    ad->prefetch_trigger = ad->search_has_more ? eina_list_data_get(l) : NULL;
+}
+
+static void
+_station_request_done(Station_Download_Context *d_ctx)
+{
+    AppData *ad = d_ctx->base.ad;
+
+    // An empty result still has to replace what the previous search showed
+    _replace_previous_results(d_ctx);
+
+    ad->search_offset = d_ctx->offset + d_ctx->delivered;
+    ad->search_has_more = (d_ctx->delivered >= d_ctx->limit);
+    ad->search_page_pending = EINA_FALSE;
+    _update_prefetch_trigger(ad);
+}
+
+static void
+_finish_station_request(Station_Download_Context *d_ctx)
+{
+    _station_request_done(d_ctx);
+    _station_request_free(d_ctx);
+}
+
+static Eina_Bool
+_restore_from_result_cache(Station_Download_Context *d_ctx)
+{
+    AppData *ad = d_ctx->base.ad;
+    Eina_List *stations;
+    Eina_Bool has_more = EINA_FALSE;
+    int offset = 0;
+    char key[1024];
+
+    _result_set_key(d_ctx, key, sizeof(key));
+    stations = result_cache_take(key, &offset, &has_more);
+    if (!stations) return EINA_FALSE;
+
+    _stash_shown_results(d_ctx);
+    ad->stations = stations;
+    ad->search_offset = offset;
+    ad->search_has_more = has_more;
+    ad->search_page_pending = EINA_FALSE;
+
+    // Favorites may have changed while the set was parked
+    favorites_apply_to_stations(ad);
+    if (ad->view_mode == VIEW_SEARCH)
+      station_list_append(ad, ad->stations);
+    _refresh_finish();
+    _update_prefetch_trigger(ad);
+    return EINA_TRUE;
+}
+
+// Show a cached page through the normal parse path. Returns EINA_TRUE when
+// the entry is fresh and the request is complete; a stale entry is shown
+// too, but d_ctx is turned into a background revalidation and the entry
+// is handed back for its validators.
+static Eina_Bool
+_serve_from_cache(Station_Download_Context *d_ctx, Search_Cache_Entry **entry_out)
+{
+    Search_Cache_Entry *entry;
+    char key[1024];
+    double age;
+
+    *entry_out = NULL;
+    _station_cache_key(d_ctx, key, sizeof(key));
+    entry = search_cache_get(key);
+    if (!entry) return EINA_FALSE;
+
+    d_ctx->parser = station_parser_new(d_ctx->format, _station_batch_cb, d_ctx);
+    station_parser_feed(d_ctx->parser, entry->body, entry->size);
+    if (!station_parser_finish(d_ctx->parser))
+      {
+         // Unreadable entry: fall back to a normal request
+         station_parser_free(d_ctx->parser);
+         d_ctx->parser = NULL;
+         search_cache_entry_free(entry);
+         return EINA_FALSE;
+      }
+
+    age = difftime(time(NULL), entry->fetched);
+    printf("Served %d stations from cache (%.0fs old)\n", d_ctx->delivered, age);
+    _station_request_done(d_ctx);
+
+    if (age >= 0 && age < search_cache_ttl_get())
+      {
+         search_cache_entry_free(entry);
+         _station_request_free(d_ctx);
+         return EINA_TRUE;
+      }
+
+    station_parser_free(d_ctx->parser);
+    d_ctx->parser = NULL;
+    d_ctx->revalidate = EINA_TRUE;
+    *entry_out = entry;
+    return EINA_FALSE;
+}
+
+static void
+_handle_revalidation_complete(Ecore_Con_Event_Url_Complete *ev, Station_Download_Context *d_ctx)
+{
+    char key[1024], etag[256] = "", last_modified[64] = "";
+
+    _station_cache_key(d_ctx, key, sizeof(key));
+    if (ev->status == 304)
+      search_cache_touch(key);
+    else if (ev->status == 200 && d_ctx->body)
+      {
+         _response_header_get(ev->url_con, "ETag", etag, sizeof(etag));
+         _response_header_get(ev->url_con, "Last-Modified", last_modified, sizeof(last_modified));
+         search_cache_put(key, eina_binbuf_string_get(d_ctx->body), eina_binbuf_length_get(d_ctx->body),
+                          etag, last_modified);
+      }
+    printf("Revalidated cached search (HTTP %d)\n", ev->status);
+    _station_request_free(d_ctx);
 }
 
 static Eina_Bool
 _handle_station_list_complete(Ecore_Con_Event_Url_Complete *ev)
 {
     Station_Download_Context *d_ctx = ecore_con_url_data_get(ev->url_con);
-    AppData *ad;
-    xmlDocPtr doc;
-    xmlXPathContextPtr xpathCtx;
-    xmlXPathObjectPtr xpathObj;
+    Eina_Bool parsed;
 
     if (!d_ctx) return EINA_FALSE;
 
-    ad = d_ctx->base.ad;
+    if (d_ctx->revalidate)
+      {
+         _handle_revalidation_complete(ev, d_ctx);
+         return EINA_FALSE;
+      }
+
+    if (d_ctx->generation != d_ctx->base.ad->search_generation)
+      {
+         printf("Dropping response of a superseded search\n");
+         _station_request_free(d_ctx);
+         return EINA_FALSE;
+      }
 
     if (ev->status != 200)
       {
@@ -281,153 +939,37 @@ _handle_station_list_complete(Ecore_Con_Event_Url_Complete *ev)
          return EINA_TRUE;
       }
 
-    if (!d_ctx->ctxt)
+    if (!d_ctx->parser)
       {
          printf("Error: no parser context; retrying next server...\n");
          _retry_next_server_station(ev->url_con, d_ctx);
          return EINA_TRUE;
       }
 
-    xmlParseChunk(d_ctx->ctxt, "", 0, 1);
-    doc = d_ctx->ctxt->myDoc;
-    xmlFreeParserCtxt(d_ctx->ctxt);
+    parsed = station_parser_finish(d_ctx->parser);
+    printf("Parsed %d stations from %s (%d bytes, %.1f ms parsing and listing)\n",
+           station_parser_count_get(d_ctx->parser), ecore_con_url_url_get(ev->url_con),
+           d_ctx->bytes, d_ctx->parse_time * 1000.0);
 
-    if (doc == NULL)
+    if (!parsed)
     {
-        printf("Error: could not parse XML; trying fallback...\n");
-        _retry_next_server_station(ev->url_con, ecore_con_url_data_get(ev->url_con));
+        printf("Error: could not parse %s; trying fallback...\n", d_ctx->format == API_FORMAT_JSON ? "JSON" : "XML");
+        _retry_next_server_station(ev->url_con, d_ctx);
         return EINA_TRUE;
     }
 
-    xpathCtx = xmlXPathNewContext(doc);
-    if (xpathCtx == NULL)
-    {
-        printf("Error: could not create new XPath context\n");
-        xmlFreeDoc(doc);
-        free(d_ctx);
-        return EINA_FALSE;
-    }
-
-    xpathObj = xmlXPathEvalExpression((xmlChar *)"//station", xpathCtx);
-    if (xpathObj == NULL)
-    {
-        printf("Error: could not evaluate xpath expression\n");
-        xmlXPathFreeContext(xpathCtx);
-        xmlFreeDoc(doc);
-        free(d_ctx);
-        return EINA_FALSE;
-    }
-
-    if (d_ctx->new_search)
+    if (d_ctx->body && !d_ctx->resumed)
     {
-        Station *st;
-        EINA_LIST_FREE(ad->stations, st)
-        {
-            eina_stringshare_del(st->name);
-            eina_stringshare_del(st->url);
-            eina_stringshare_del(st->favicon);
-            eina_stringshare_del(st->stationuuid);
-            eina_stringshare_del(st->country);
-            eina_stringshare_del(st->language);
-            eina_stringshare_del(st->codec);
-            eina_stringshare_del(st->tags);
-            free(st);
-        }
-        ad->stations = NULL;
-    }
+        char key[1024], etag[256] = "", last_modified[64] = "";
 
-    for (int i = 0; i < xpathObj->nodesetval->nodeNr; i++)
-    {
-        xmlNodePtr cur = xpathObj->nodesetval->nodeTab[i];
-        Station *st = calloc(1, sizeof(Station));
-        xmlChar *prop;
-
-        prop = xmlGetProp(cur, (xmlChar *)"name");
-        if (prop)
-          {
-             st->name = eina_stringshare_add((const char *)prop);
-             xmlFree(prop);
-          }
-
-        prop = xmlGetProp(cur, (xmlChar *)"url_resolved");
-        if (prop)
-          {
-             st->url = eina_stringshare_add((const char *)prop);
-             xmlFree(prop);
-          }
-
-        prop = xmlGetProp(cur, (xmlChar *)"favicon");
-        if (prop)
-          {
-             st->favicon = eina_stringshare_add((const char *)prop);
-             xmlFree(prop);
-          }
-
-        prop = xmlGetProp(cur, (xmlChar *)"stationuuid");
-        if (prop)
-          {
-             st->stationuuid = eina_stringshare_add((const char *)prop);
-             xmlFree(prop);
-          }
-
-        prop = xmlGetProp(cur, (xmlChar *)"country");
-        if (prop)
-          {
-             st->country = eina_stringshare_add((const char *)prop);
-             xmlFree(prop);
-          }
-
-        prop = xmlGetProp(cur, (xmlChar *)"language");
-        if (prop)
-          {
-             st->language = eina_stringshare_add((const char *)prop);
-             xmlFree(prop);
-          }
-
-        prop = xmlGetProp(cur, (xmlChar *)"codec");
-        if (prop)
-          {
-             st->codec = eina_stringshare_add((const char *)prop);
-             xmlFree(prop);
-          }
-
-        prop = xmlGetProp(cur, (xmlChar *)"tags");
-        if (prop)
-          {
-             st->tags = eina_stringshare_add((const char *)prop);
-             xmlFree(prop);
-          }
-
-        prop = xmlGetProp(cur, (xmlChar *)"bitrate");
-        if (prop)
-          {
-             st->bitrate = atoi((const char *)prop);
-             xmlFree(prop);
-          }
-
-        // Add to list - check for failure to avoid memory leak
-        Eina_List *new_list = eina_list_append(ad->stations, st);
-        if (!new_list)
-        {
-            // List append failed, clean up the station
-            _station_free(st);
-        }
-        else
-        {
-            ad->stations = new_list;
-        }
+        _station_cache_key(d_ctx, key, sizeof(key));
+        _response_header_get(ev->url_con, "ETag", etag, sizeof(etag));
+        _response_header_get(ev->url_con, "Last-Modified", last_modified, sizeof(last_modified));
+        search_cache_put(key, eina_binbuf_string_get(d_ctx->body), eina_binbuf_length_get(d_ctx->body),
+                         etag, last_modified);
     }
 
-    favorites_apply_to_stations(ad);
-    if (ad->view_mode == VIEW_SEARCH)
-      station_list_populate(ad, d_ctx->new_search);
-
-    eina_list_free(d_ctx->servers);
-    free(d_ctx);
-
-    xmlXPathFreeObject(xpathObj);
-    xmlXPathFreeContext(xpathCtx);
-    xmlFreeDoc(doc);
+    _finish_station_request(d_ctx);
     return EINA_FALSE;
 }
 
@@ -441,12 +983,27 @@ _url_data_cb(void *data, int type, void *event_info)
 
     if (ctx->type == DOWNLOAD_TYPE_STATIONS)
       _handle_station_list_data(url_data);
-    else if (ctx->type == DOWNLOAD_TYPE_ICON)
-      _handle_icon_data(url_data);
+    else if (ctx->type == DOWNLOAD_TYPE_COUNTER)
+      {
+         Counter_Download_Context *c_ctx = (Counter_Download_Context *)ctx;
+         if (c_ctx->ttfb < 0.0)
+           c_ctx->ttfb = ecore_time_get() - c_ctx->started;
+      }
 
     return ECORE_CALLBACK_PASS_ON;
 }
 
+static Eina_Bool
+_url_progress_cb(void *data EINA_UNUSED, int type EINA_UNUSED, void *event_info)
+{
+    Ecore_Con_Event_Url_Progress *ev = event_info;
+    Download_Context *ctx = ecore_con_url_data_get(ev->url_con);
+
+    if (ctx && ctx->type == DOWNLOAD_TYPE_ICON)
+      _handle_icon_progress(ev);
+    return ECORE_CALLBACK_PASS_ON;
+}
+
 static Eina_Bool
 _url_complete_cb(void *data, int type, void *event_info)
 {
@@ -464,14 +1021,17 @@ _url_complete_cb(void *data, int type, void *event_info)
 
     if (ctx->type == DOWNLOAD_TYPE_STATIONS)
       {
+         // Background revalidations never started the loading indicator
+         Eina_Bool background = ((Station_Download_Context *)ctx)->revalidate;
          if (_handle_station_list_complete(ev))
            return ECORE_CALLBACK_PASS_ON;
-         ui_loading_stop(ad);
+         if (!background)
+           ui_loading_stop(ad);
       }
     else if (ctx->type == DOWNLOAD_TYPE_ICON)
       {
+         // Favicons load in the background without the loading indicator
          _handle_icon_complete(ev);
-         ui_loading_stop(ad);
       }
     else if (ctx->type == DOWNLOAD_TYPE_COUNTER)
       {
@@ -483,6 +1043,8 @@ _url_complete_cb(void *data, int type, void *event_info)
            }
          // No further action needed; just free context
          Counter_Download_Context *c_ctx = (Counter_Download_Context *)ctx;
+         // An empty answer still counts as a success, just without a sample
+         server_stats_success(eina_list_data_get(c_ctx->current), c_ctx->ttfb);
          eina_list_free(c_ctx->servers);
          free(c_ctx);
          ui_loading_stop(ad);
@@ -492,75 +1054,7 @@ _url_complete_cb(void *data, int type, void *event_info)
     return ECORE_CALLBACK_PASS_ON;
 }
 
-// -------- Helper functions for API server discovery & selection ---------
-
-static void _add_unique_server(AppData *ad, const char *hostname)
-{
-   if (!hostname || !hostname[0]) return;
-   // ensure uniqueness
-   Eina_List *l;
-   const char *h;
-   EINA_LIST_FOREACH(ad->api_servers, l, h)
-   {
-      if (strcmp(h, hostname) == 0) return;
-   }
-   ad->api_servers = eina_list_append(ad->api_servers, eina_stringshare_add(hostname));
-}
-
-static void _refresh_api_servers(AppData *ad)
-{
-   // Resolve all.api.radio-browser.info to get all server IPs
-   struct addrinfo hints = {0}, *res = NULL, *p;
-   hints.ai_family = AF_UNSPEC;
-   hints.ai_socktype = SOCK_STREAM;
-   int ret = getaddrinfo("all.api.radio-browser.info", NULL, &hints, &res);
-   if (ret != 0)
-   {
-      printf("DNS lookup failed: %s\n", gai_strerror(ret));
-      return;
-   }
-
-   for (p = res; p != NULL; p = p->ai_next)
-   {
-      char host[NI_MAXHOST];
-      // Reverse DNS to get human-readable server names
-      int r = getnameinfo(p->ai_addr, p->ai_addrlen, host, sizeof(host), NULL, 0, NI_NAMEREQD);
-      if (r == 0)
-      {
-         _add_unique_server(ad, host);
-      }
-      else
-      {
-         // Fallback: if reverse lookup fails, use the numeric address
-         char addrstr[INET6_ADDRSTRLEN] = {0};
-         void *addr = NULL;
-         if (p->ai_family == AF_INET)
-           addr = &((struct sockaddr_in *)p->ai_addr)->sin_addr;
-         else if (p->ai_family == AF_INET6)
-           addr = &((struct sockaddr_in6 *)p->ai_addr)->sin6_addr;
-         if (addr)
-         {
-            inet_ntop(p->ai_family, addr, addrstr, sizeof(addrstr));
-            _add_unique_server(ad, addrstr);
-         }
-      }
-   }
-
-   freeaddrinfo(res);
-}
-
-static void _randomize_servers(AppData *ad)
-{
-   if (!ad->api_servers) return;
-   srand(time(NULL));
-   ad->api_servers = eina_list_shuffle(ad->api_servers, NULL);
-}
-
-static const char *_primary_server(AppData *ad)
-{
-   if (!ad->api_servers) return NULL;
-   return eina_list_data_get(ad->api_servers);
-}
+// -------- Helper functions for API server selection ---------
 
 static void _prepend_selected_as_primary(Eina_List **list, const char *selected)
 {
@@ -584,7 +1078,7 @@ static void _populate_station_request(Station_Download_Context *d_ctx, AppData *
    strncpy(d_ctx->search_term, search_term ? search_term : "", sizeof(d_ctx->search_term) - 1);
    strncpy(d_ctx->order, order ? order : "name", sizeof(d_ctx->order) - 1);
    d_ctx->reverse = reverse;
-   d_ctx->servers = eina_list_clone(ad->api_servers);
+   d_ctx->servers = server_stats_order(ad->api_servers);
    _prepend_selected_as_primary(&d_ctx->servers, ad->api_selected);
    d_ctx->current = d_ctx->servers; // start at primary
 }
@@ -592,37 +1086,70 @@ static void _populate_station_request(Station_Download_Context *d_ctx, AppData *
 static void _issue_station_request(Ecore_Con_Url **url_out, Station_Download_Context *d_ctx)
 {
    const char *server = d_ctx->current ? (const char *)d_ctx->current->data : NULL;
+   const char *format = (d_ctx->format == API_FORMAT_JSON) ? "json" : "xml";
    char url_str[2048];
    char query_params[1024] = {0};
 
    // Start with the base search params
    snprintf(query_params, sizeof(query_params), "%s=%s", d_ctx->search_type, d_ctx->search_term);
 
-   // Add sorting and pagination params
+   // Add sorting and pagination params; a fallback server resumes after
+   // the stations the failed one already delivered
    char other_params[512];
-   snprintf(other_params, sizeof(other_params), "&limit=%d&order=%s&reverse=%s",
-            100000, d_ctx->order, d_ctx->reverse ? "true" : "false");
+   snprintf(other_params, sizeof(other_params), "&offset=%d&limit=%d&order=%s&reverse=%s",
+            d_ctx->offset + d_ctx->delivered, d_ctx->limit - d_ctx->delivered,
+            d_ctx->order, d_ctx->reverse ? "true" : "false");
 
    strncat(query_params, other_params, sizeof(query_params) - strlen(query_params) - 1);
 
    if (server)
-      snprintf(url_str, sizeof(url_str), "http://%s/xml/stations/search?%s", server, query_params);
+      snprintf(url_str, sizeof(url_str), "http://%s/%s/stations/search?%s", server, format, query_params);
    else
-      snprintf(url_str, sizeof(url_str), "http://de2.api.radio-browser.info/xml/stations/search?%s", query_params);
+      snprintf(url_str, sizeof(url_str), "http://de2.api.radio-browser.info/%s/stations/search?%s", format, query_params);
 
    printf("Request URL: %s\n", url_str);
    *url_out = ecore_con_url_new(url_str);
+   d_ctx->url = *url_out;
+   d_ctx->started = ecore_time_get();
+   d_ctx->first_byte = EINA_FALSE;
 }
 
 static void _retry_next_server_station(Ecore_Con_Url *old_url, Station_Download_Context *d_ctx)
 {
+   server_stats_failure(eina_list_data_get(d_ctx->current));
+
+   if (d_ctx->peer)
+   {
+      // The hedged twin is still racing; let it carry on alone
+      AppData *ad = d_ctx->base.ad;
+      ecore_con_url_free(old_url);
+      _station_request_free(d_ctx);
+      ui_loading_stop(ad);
+      return;
+   }
+
+   if (d_ctx->delivered >= d_ctx->limit)
+   {
+      // The failed server already delivered the whole page
+      ecore_con_url_free(old_url);
+      AppData *ad = d_ctx->base.ad;
+      _finish_station_request(d_ctx);
+      ui_loading_stop(ad);
+      return;
+   }
+
    if (d_ctx->current && d_ctx->current->next)
    {
-      if (d_ctx->ctxt)
+      if (d_ctx->parser)
         {
-           xmlFreeParserCtxt(d_ctx->ctxt);
-           d_ctx->ctxt = NULL;
+           station_parser_free(d_ctx->parser);
+           d_ctx->parser = NULL;
         }
+      // The failed server's body is useless; a resumed page is never cached
+      if (d_ctx->body) eina_binbuf_reset(d_ctx->body);
+      d_ctx->resumed = (d_ctx->delivered > 0);
+      d_ctx->bytes = 0;
+      d_ctx->parse_time = 0.0;
       d_ctx->current = d_ctx->current->next;
       Ecore_Con_Url *new_url;
       _issue_station_request(&new_url, d_ctx);
@@ -630,21 +1157,16 @@ static void _retry_next_server_station(Ecore_Con_Url *old_url, Station_Download_
       ecore_con_url_data_set(new_url, d_ctx);
       ecore_con_url_get(new_url);
       ecore_con_url_free(old_url);
+      _hedge_arm(d_ctx);
    }
    else
    {
       printf("All servers exhausted; failing request.\n");
       ecore_con_url_free(old_url);
-      // free context and notify UI of failure
-      if (d_ctx->ctxt)
-      {
-         xmlFreeParserCtxt(d_ctx->ctxt);
-         d_ctx->ctxt = NULL;
-      }
       // Save ad pointer before freeing context to avoid use-after-free
       AppData *ad = d_ctx->base.ad;
-      eina_list_free(d_ctx->servers);
-      free(d_ctx);
+      ad->search_page_pending = EINA_FALSE;
+      _station_request_free(d_ctx);
       ui_loading_stop(ad);
    }
 }
@@ -662,7 +1184,7 @@ static void _populate_counter_request(Counter_Download_Context *c_ctx, AppData *
 
    fprintf(stderr, "LOG: _populate_counter_request: ad=%p, ad->api_servers=%p\n", ad, ad->api_servers);
    strncpy(c_ctx->stationuuid, uuid, sizeof(c_ctx->stationuuid) - 1);
-   c_ctx->servers = eina_list_clone(ad->api_servers);
+   c_ctx->servers = server_stats_order(ad->api_servers);
    _prepend_selected_as_primary(&c_ctx->servers, ad->api_selected);
    c_ctx->current = c_ctx->servers;
 }
@@ -678,10 +1200,14 @@ static void _issue_counter_request(Ecore_Con_Url **url_out, Counter_Download_Con
 
    printf("Counter Request URL: %s\n", url_str);
    *url_out = ecore_con_url_new(url_str);
+   c_ctx->started = ecore_time_get();
+   c_ctx->ttfb = -1.0;
 }
 
 static void _retry_next_server_counter(Ecore_Con_Url *old_url, Counter_Download_Context *c_ctx)
 {
+   server_stats_failure(eina_list_data_get(c_ctx->current));
+
    if (c_ctx->current && c_ctx->current->next)
    {
       c_ctx->current = c_ctx->current->next;
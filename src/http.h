@@ -1,11 +1,30 @@
 #pragma once
 
+#include <Ecore_Con.h>
+
 #include "appdata.h"
 
 void http_init(AppData *ad);
 void http_shutdown(void);
 void http_search_stations(AppData *ad, const char *search_term, const char *search_type, const char *order, Eina_Bool reverse, Eina_Bool new_search);
-void http_download_icon(AppData *ad, Elm_Object_Item *list_item, const char *url);
+void http_search_stations_next_page(AppData *ad);
+
+// Called once per icon download. path is where the body was stored, or
+// NULL if the request failed or the body was empty or grew past max_size
+// (status 200); status is the HTTP status, 0 without a response
+// (connection error or timeout), or HTTP_ICON_LOCAL_ERROR if a good
+// response could not be stored (disk full, cache directory not writable).
+#define HTTP_ICON_LOCAL_ERROR -1
+typedef void (*Http_Icon_Done_Cb)(void *data, const char *path, size_t size, int status, const char *content_type);
+
+// Fetch a favicon into the file at path. The body is streamed into
+// path.tmp and renamed over path once complete, so path never holds a
+// partial icon. Returns a handle for http_download_icon_cancel, or NULL.
+Ecore_Con_Url *http_download_icon(AppData *ad, const char *url, const char *path, size_t max_size, Http_Icon_Done_Cb done_cb, const void *data);
+// Abort a download without calling its callback
+void http_download_icon_cancel(Ecore_Con_Url *url);
+
 void _search_btn_clicked_cb(void *data, Evas_Object *obj, void *event_info);
 void _search_entry_activated_cb(void *data, Evas_Object *obj, void *event_info);
+void _search_entry_changed_cb(void *data, Evas_Object *obj, void *event_info);
 void http_station_click_counter(AppData *ad, const char *uuid);
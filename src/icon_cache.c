@@ -0,0 +1,389 @@
+#include <Ecore.h>
+#include <Ecore_File.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "icon_cache.h"
+
+#define ICON_CACHE_DEFAULT_MB 20
+#define ICON_CACHE_SAVE_DELAY 5.0    // seconds to batch index rewrites
+#define ICON_INDEX_NAME "index"
+#define ICON_FAILED_NAME "failed"
+#define ICON_FAILED_PERMANENT_TTL (7 * 24 * 60 * 60)
+#define ICON_FAILED_TRANSIENT_TTL (60 * 60)
+
+typedef struct _Icon_Entry
+{
+   const char *key;        // stringshare
+   const char *url;        // stringshare
+   size_t size;
+   time_t atime;
+} Icon_Entry;
+
+static Eina_Hash *_entries = NULL;
+static Eina_Hash *_failed = NULL;    // url -> expiry time, boxed
+static size_t _total = 0;
+static size_t _budget = 0;
+static Eina_Bool _dirty = EINA_FALSE;
+static Ecore_Timer *_save_timer = NULL;
+static Icon_Cache_Evict_Cb _evict_cb = NULL;
+
+static Eina_Bool
+_dir_get(char *buf, size_t len)
+{
+   const char *home = getenv("HOME");
+   if (!home) return EINA_FALSE;
+   snprintf(buf, len, "%s/.cache/eradio/favicons", home);
+   return EINA_TRUE;
+}
+
+Eina_Bool
+icon_cache_path_get(const char *key, char *buf, size_t len)
+{
+   char dir[PATH_MAX];
+
+   if (!key || !key[0] || strchr(key, '/') || !_dir_get(dir, sizeof(dir))) return EINA_FALSE;
+   snprintf(buf, len, "%s/%s", dir, key);
+   return EINA_TRUE;
+}
+
+static void
+_entry_free(void *data)
+{
+   Icon_Entry *e = data;
+   eina_stringshare_del(e->key);
+   eina_stringshare_del(e->url);
+   free(e);
+}
+
+static Icon_Entry *
+_entry_set(const char *key, const char *url, size_t size, time_t atime)
+{
+   Icon_Entry *e = eina_hash_find(_entries, key);
+
+   if (e)
+     _total -= e->size;
+   else
+     {
+        e = calloc(1, sizeof(Icon_Entry));
+        if (!e) return NULL;
+        e->key = eina_stringshare_add(key);
+        eina_hash_add(_entries, key, e);
+     }
+   eina_stringshare_replace(&e->url, url);
+   e->size = size;
+   e->atime = atime;
+   _total += size;
+   return e;
+}
+
+// Lines are "<key> <size> <atime> <url>"
+static Eina_Bool
+_index_load(const char *path)
+{
+   char line[4096], key[256];
+   unsigned long long size;
+   long long atime;
+   int url_at;
+   FILE *f = fopen(path, "r");
+
+   if (!f) return EINA_FALSE;
+   while (fgets(line, sizeof(line), f))
+     {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (sscanf(line, "%255s %llu %lld %n", key, &size, &atime, &url_at) != 3) continue;
+        _entry_set(key, line + url_at, size, (time_t)atime);
+     }
+   fclose(f);
+   return EINA_TRUE;
+}
+
+// Without an index (first run with one) the existing files are adopted
+// once; every later start only reads the index
+static void
+_index_rebuild(const char *dir)
+{
+   Eina_List *files = ecore_file_ls(dir);
+   char *name, path[PATH_MAX];
+   struct stat st;
+
+   EINA_LIST_FREE(files, name)
+     {
+        snprintf(path, sizeof(path), "%s/%s", dir, name);
+        if (strcmp(name, ICON_INDEX_NAME) != 0 && strcmp(name, ICON_FAILED_NAME) != 0 &&
+            !strstr(name, ".tmp") &&
+            stat(path, &st) == 0 && S_ISREG(st.st_mode))
+          _entry_set(name, "", st.st_size, st.st_atime);
+        free(name);
+     }
+   _dirty = EINA_TRUE;
+}
+
+static Eina_Bool
+_index_write_cb(const Eina_Hash *hash EINA_UNUSED, const void *key EINA_UNUSED, void *data, void *fdata)
+{
+   const Icon_Entry *e = data;
+   fprintf(fdata, "%s %zu %lld %s\n", e->key, e->size, (long long)e->atime, e->url ? e->url : "");
+   return EINA_TRUE;
+}
+
+static void
+_index_save(void)
+{
+   char dir[PATH_MAX], path[PATH_MAX], tmp[PATH_MAX + 8];
+   FILE *f;
+
+   if (!_dirty || !_entries || !_dir_get(dir, sizeof(dir))) return;
+   ecore_file_mkpath(dir);
+   snprintf(path, sizeof(path), "%s/%s", dir, ICON_INDEX_NAME);
+   snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+   f = fopen(tmp, "w");
+   if (!f) return;
+   eina_hash_foreach(_entries, _index_write_cb, f);
+   if (fclose(f) != 0 || rename(tmp, path) == -1)
+     {
+        unlink(tmp);
+        return;
+     }
+   _dirty = EINA_FALSE;
+}
+
+// Lines are "<expiry> <url>"
+static void
+_failed_load(const char *path)
+{
+   char line[4096];
+   long long expiry;
+   int url_at;
+   time_t now = time(NULL);
+   FILE *f = fopen(path, "r");
+
+   if (!f) return;
+   while (fgets(line, sizeof(line), f))
+     {
+        time_t *e;
+
+        line[strcspn(line, "\r\n")] = '\0';
+        if (sscanf(line, "%lld %n", &expiry, &url_at) != 1 || expiry <= now || !line[url_at]) continue;
+        e = malloc(sizeof(time_t));
+        if (!e) break;
+        *e = (time_t)expiry;
+        // eina_hash_set hands back the value it replaces without freeing it
+        free(eina_hash_set(_failed, line + url_at, e));
+     }
+   fclose(f);
+}
+
+static Eina_Bool
+_failed_write_cb(const Eina_Hash *hash EINA_UNUSED, const void *key, void *data, void *fdata)
+{
+   const time_t *expiry = data;
+   if (*expiry > time(NULL))
+     fprintf(fdata, "%lld %s\n", (long long)*expiry, (const char *)key);
+   return EINA_TRUE;
+}
+
+static void
+_failed_save(void)
+{
+   char dir[PATH_MAX], path[PATH_MAX], tmp[PATH_MAX + 8];
+   FILE *f;
+
+   if (!_failed || !_dir_get(dir, sizeof(dir))) return;
+   ecore_file_mkpath(dir);
+   snprintf(path, sizeof(path), "%s/%s", dir, ICON_FAILED_NAME);
+   snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+   f = fopen(tmp, "w");
+   if (!f) return;
+   eina_hash_foreach(_failed, _failed_write_cb, f);
+   if (fclose(f) != 0 || rename(tmp, path) == -1)
+     unlink(tmp);
+}
+
+static Eina_Bool
+_save_timer_cb(void *data EINA_UNUSED)
+{
+   _save_timer = NULL;
+   _index_save();
+   _failed_save();
+   return ECORE_CALLBACK_CANCEL;
+}
+
+static void
+_mark_dirty(void)
+{
+   _dirty = EINA_TRUE;
+   if (!_save_timer)
+     _save_timer = ecore_timer_add(ICON_CACHE_SAVE_DELAY, _save_timer_cb, NULL);
+}
+
+static Eina_Bool
+_collect_cb(const Eina_Hash *hash EINA_UNUSED, const void *key EINA_UNUSED, void *data, void *fdata)
+{
+   Eina_List **list = fdata;
+   *list = eina_list_append(*list, data);
+   return EINA_TRUE;
+}
+
+static int
+_atime_cmp(const void *a, const void *b)
+{
+   const Icon_Entry *ea = a, *eb = b;
+   return (ea->atime > eb->atime) - (ea->atime < eb->atime);
+}
+
+// Evict least recently used entries down to 90% of the budget, so a full
+// cache does not evict on every new icon
+static void
+_evict(const char *keep)
+{
+   Eina_List *all = NULL;
+   Icon_Entry *e;
+   char path[PATH_MAX];
+   int evicted = 0;
+
+   if (_total <= _budget) return;
+
+   eina_hash_foreach(_entries, _collect_cb, &all);
+   all = eina_list_sort(all, 0, _atime_cmp);
+   EINA_LIST_FREE(all, e)
+     {
+        if (_total <= _budget / 10 * 9) continue;
+        if (e->key == keep || !strcmp(e->key, keep)) continue;
+        if (icon_cache_path_get(e->key, path, sizeof(path)))
+          unlink(path);
+        _total -= e->size;
+        e->size = 0;
+        if (_evict_cb) _evict_cb(e->key);
+        eina_hash_del_by_key(_entries, e->key);
+        evicted++;
+     }
+   printf("Favicon cache: evicted %d icons, %zu of %zu bytes used\n", evicted, _total, _budget);
+   _mark_dirty();
+}
+
+void
+icon_cache_evict_cb_set(Icon_Cache_Evict_Cb cb)
+{
+   _evict_cb = cb;
+}
+
+void
+icon_cache_init(void)
+{
+   const char *mb = getenv("ERADIO_FAVICON_CACHE_MB");
+   char dir[PATH_MAX], path[PATH_MAX];
+
+   _budget = (size_t)((mb && atoi(mb) > 0) ? atoi(mb) : ICON_CACHE_DEFAULT_MB) * 1024 * 1024;
+   _entries = eina_hash_string_superfast_new(_entry_free);
+   _failed = eina_hash_string_superfast_new(free);
+   if (!_dir_get(dir, sizeof(dir))) return;
+   // Downloads write into the directory directly, so it has to exist
+   ecore_file_mkpath(dir);
+
+   snprintf(path, sizeof(path), "%s/%s", dir, ICON_FAILED_NAME);
+   _failed_load(path);
+
+   snprintf(path, sizeof(path), "%s/%s", dir, ICON_INDEX_NAME);
+   if (!_index_load(path))
+     _index_rebuild(dir);
+   _evict("");
+}
+
+void
+icon_cache_shutdown(void)
+{
+   if (_save_timer) ecore_timer_del(_save_timer);
+   _save_timer = NULL;
+   _index_save();
+   _failed_save();
+   if (_entries) eina_hash_free(_entries);
+   _entries = NULL;
+   if (_failed) eina_hash_free(_failed);
+   _failed = NULL;
+   _total = 0;
+}
+
+Eina_Bool
+icon_cache_has(const char *key)
+{
+   return _entries && key && eina_hash_find(_entries, key) != NULL;
+}
+
+void
+icon_cache_touch(const char *key)
+{
+   Icon_Entry *e = (_entries && key) ? eina_hash_find(_entries, key) : NULL;
+   time_t now = time(NULL);
+
+   // Minute resolution is plenty for LRU and keeps scrolling from
+   // dirtying the index on every frame
+   if (!e || now - e->atime < 60) return;
+   e->atime = now;
+   _mark_dirty();
+}
+
+void
+icon_cache_add(const char *key, const char *url, size_t size)
+{
+   if (!_entries || !key) return;
+   _entry_set(key, url ? url : "", size, time(NULL));
+   _mark_dirty();
+   _evict(key);
+}
+
+Eina_Bool
+icon_cache_rename(const char *old_key, const char *new_key)
+{
+   Icon_Entry *e = (_entries && old_key) ? eina_hash_find(_entries, old_key) : NULL;
+   char from[PATH_MAX], to[PATH_MAX];
+   const char *url;
+   size_t size;
+   time_t atime;
+
+   if (!e || !new_key) return EINA_FALSE;
+   if (!icon_cache_path_get(old_key, from, sizeof(from)) ||
+       !icon_cache_path_get(new_key, to, sizeof(to)) ||
+       rename(from, to) == -1)
+     return EINA_FALSE;
+
+   url = eina_stringshare_ref(e->url);
+   size = e->size;
+   atime = e->atime;
+   _total -= size;
+   eina_hash_del_by_key(_entries, old_key);
+   _entry_set(new_key, url, size, atime);
+   eina_stringshare_del(url);
+   _mark_dirty();
+   return EINA_TRUE;
+}
+
+void
+icon_cache_failure_add(const char *url, Eina_Bool permanent)
+{
+   time_t *expiry;
+
+   if (!_failed || !url || !url[0]) return;
+   expiry = malloc(sizeof(time_t));
+   if (!expiry) return;
+   *expiry = time(NULL) + (permanent ? ICON_FAILED_PERMANENT_TTL : ICON_FAILED_TRANSIENT_TTL);
+   free(eina_hash_set(_failed, url, expiry));
+   _mark_dirty();
+}
+
+Eina_Bool
+icon_cache_failed(const char *url)
+{
+   time_t *expiry = (_failed && url) ? eina_hash_find(_failed, url) : NULL;
+
+   if (!expiry) return EINA_FALSE;
+   if (*expiry > time(NULL)) return EINA_TRUE;
+   eina_hash_del_by_key(_failed, url);
+   return EINA_FALSE;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <Eina.h>
+
+// On-disk favicon store in ~/.cache/eradio/favicons. An index file records
+// size, last access and source URL of every entry, so startup reads one
+// file instead of the directory, and the total size is kept under a byte
+// budget (ERADIO_FAVICON_CACHE_MB, default 20) by evicting the least
+// recently used entries.
+
+void icon_cache_init(void);
+void icon_cache_shutdown(void);
+
+// cb is called with the key of every entry evicted for the budget, so
+// data derived from it can go too. Set it before icon_cache_init().
+typedef void (*Icon_Cache_Evict_Cb)(const char *key);
+void icon_cache_evict_cb_set(Icon_Cache_Evict_Cb cb);
+
+// Path of the file stored (or to be stored) for key
+Eina_Bool icon_cache_path_get(const char *key, char *buf, size_t len);
+
+Eina_Bool icon_cache_has(const char *key);
+
+// Record a use of key for the LRU order
+void icon_cache_touch(const char *key);
+
+// Register a file just stored at icon_cache_path_get(key), evicting old
+// entries if the budget is exceeded
+void icon_cache_add(const char *key, const char *url, size_t size);
+
+// Move the entry stored under old_key to new_key. Returns EINA_FALSE if
+// there is no entry for old_key.
+Eina_Bool icon_cache_rename(const char *old_key, const char *new_key);
+
+// Negative cache: favicon URLs that failed are not requested again until
+// their entry expires. Permanent failures (HTTP 4xx, not an image, too
+// large) are remembered for a week, transient ones for an hour.
+void icon_cache_failure_add(const char *url, Eina_Bool permanent);
+Eina_Bool icon_cache_failed(const char *url);
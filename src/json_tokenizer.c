@@ -0,0 +1,322 @@
+#include <string.h>
+
+#include "json_tokenizer.h"
+
+enum {
+   STATE_VALUE,
+   STATE_STRING,
+   STATE_ESCAPE,
+   STATE_UNICODE,
+   STATE_NUMBER,
+   STATE_LITERAL
+};
+
+void
+json_tokenizer_init(Json_Tokenizer *t, Json_Token_Cb cb, const void *data)
+{
+   memset(t, 0, sizeof(*t));
+   t->state = STATE_VALUE;
+   t->cb = cb;
+   t->data = (void *)data;
+}
+
+static void
+_append(Json_Tokenizer *t, char c)
+{
+   // Keep room for the terminating NUL; anything beyond is dropped
+   if (t->len < sizeof(t->buf) - 1)
+     t->buf[t->len++] = c;
+}
+
+static void
+_append_codepoint(Json_Tokenizer *t, unsigned int cp)
+{
+   char out[4];
+   size_t n;
+
+   if (cp < 0x80)
+     {
+        out[0] = cp;
+        n = 1;
+     }
+   else if (cp < 0x800)
+     {
+        out[0] = 0xC0 | (cp >> 6);
+        out[1] = 0x80 | (cp & 0x3F);
+        n = 2;
+     }
+   else if (cp < 0x10000)
+     {
+        out[0] = 0xE0 | (cp >> 12);
+        out[1] = 0x80 | ((cp >> 6) & 0x3F);
+        out[2] = 0x80 | (cp & 0x3F);
+        n = 3;
+     }
+   else
+     {
+        out[0] = 0xF0 | (cp >> 18);
+        out[1] = 0x80 | ((cp >> 12) & 0x3F);
+        out[2] = 0x80 | ((cp >> 6) & 0x3F);
+        out[3] = 0x80 | (cp & 0x3F);
+        n = 4;
+     }
+
+   // Never split a character when the buffer is nearly full
+   if (t->len + n < sizeof(t->buf))
+     {
+        memcpy(t->buf + t->len, out, n);
+        t->len += n;
+     }
+}
+
+// Drop an incomplete UTF-8 sequence left at the end of a truncated token
+static void
+_utf8_trim(Json_Tokenizer *t)
+{
+   size_t i = t->len, cont = 0;
+   unsigned char lead;
+   size_t need;
+
+   if (t->len < sizeof(t->buf) - 1) return;
+
+   while (i > 0 && cont < 3 && ((unsigned char)t->buf[i - 1] & 0xC0) == 0x80)
+     {
+        i--;
+        cont++;
+     }
+   if (i == 0) return;
+
+   lead = t->buf[i - 1];
+   if (lead < 0x80) return;
+   need = (lead >= 0xF0) ? 3 : (lead >= 0xE0) ? 2 : 1;
+   if (cont < need)
+     t->len = i - 1;
+}
+
+static void
+_emit(Json_Tokenizer *t, Json_Token_Type type)
+{
+   _utf8_trim(t);
+   t->buf[t->len] = '\0';
+   if (t->cb) t->cb(t->data, type, t->buf, t->len, t->depth);
+   t->len = 0;
+}
+
+static void
+_emit_literal(Json_Tokenizer *t)
+{
+   t->buf[t->len] = '\0';
+   if (!strcmp(t->buf, "true"))
+     _emit(t, JSON_TOKEN_TRUE);
+   else if (!strcmp(t->buf, "false"))
+     _emit(t, JSON_TOKEN_FALSE);
+   else if (!strcmp(t->buf, "null"))
+     _emit(t, JSON_TOKEN_NULL);
+   else
+     t->error = EINA_TRUE;
+}
+
+static void
+_push(Json_Tokenizer *t, char c, Json_Token_Type type)
+{
+   if (t->depth >= JSON_MAX_DEPTH)
+     {
+        t->error = EINA_TRUE;
+        return;
+     }
+   t->stack[t->depth++] = c;
+   t->expect_key = (c == '{');
+   _emit(t, type);
+}
+
+static void
+_pop(Json_Tokenizer *t, char c, Json_Token_Type type)
+{
+   if (t->depth == 0 || t->stack[t->depth - 1] != c)
+     {
+        t->error = EINA_TRUE;
+        return;
+     }
+   _emit(t, type);
+   t->depth--;
+   t->expect_key = EINA_FALSE;
+}
+
+static int
+_hex_value(char c)
+{
+   if (c >= '0' && c <= '9') return c - '0';
+   if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+   if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+   return -1;
+}
+
+static void
+_unicode_done(Json_Tokenizer *t)
+{
+   unsigned int cp = t->codepoint;
+
+   if (cp >= 0xD800 && cp <= 0xDBFF)
+     {
+        // High surrogate; the low half follows as another \\u escape
+        t->high_surrogate = cp;
+        return;
+     }
+   if (cp >= 0xDC00 && cp <= 0xDFFF)
+     {
+        if (!t->high_surrogate) return;
+        cp = 0x10000 + ((t->high_surrogate - 0xD800) << 10) + (cp - 0xDC00);
+     }
+   t->high_surrogate = 0;
+   _append_codepoint(t, cp);
+}
+
+// Consume one byte of structure or scalar. Returns EINA_FALSE when the
+// byte terminated a number or literal and must be looked at again.
+static Eina_Bool
+_step(Json_Tokenizer *t, char c)
+{
+   switch (t->state)
+     {
+      case STATE_STRING:
+        if (c == '"')
+          {
+             t->state = STATE_VALUE;
+             _emit(t, t->expect_key ? JSON_TOKEN_KEY : JSON_TOKEN_STRING);
+          }
+        else if (c == '\\')
+          t->state = STATE_ESCAPE;
+        else
+          _append(t, c);
+        return EINA_TRUE;
+
+      case STATE_ESCAPE:
+        t->state = STATE_STRING;
+        switch (c)
+          {
+           case '"': case '\\': case '/': _append(t, c); break;
+           case 'b': _append(t, '\b'); break;
+           case 'f': _append(t, '\f'); break;
+           case 'n': _append(t, '\n'); break;
+           case 'r': _append(t, '\r'); break;
+           case 't': _append(t, '\t'); break;
+           case 'u':
+             t->state = STATE_UNICODE;
+             t->codepoint = 0;
+             t->hex_digits = 0;
+             break;
+           default:
+             t->error = EINA_TRUE;
+          }
+        return EINA_TRUE;
+
+      case STATE_UNICODE:
+        {
+           int v = _hex_value(c);
+           if (v < 0)
+             {
+                t->error = EINA_TRUE;
+                return EINA_TRUE;
+             }
+           t->codepoint = (t->codepoint << 4) | v;
+           if (++t->hex_digits == 4)
+             {
+                t->state = STATE_STRING;
+                _unicode_done(t);
+             }
+        }
+        return EINA_TRUE;
+
+      case STATE_NUMBER:
+        if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')
+          {
+             _append(t, c);
+             return EINA_TRUE;
+          }
+        t->state = STATE_VALUE;
+        _emit(t, JSON_TOKEN_NUMBER);
+        return EINA_FALSE;
+
+      case STATE_LITERAL:
+        if (c >= 'a' && c <= 'z')
+          {
+             _append(t, c);
+             return EINA_TRUE;
+          }
+        t->state = STATE_VALUE;
+        _emit_literal(t);
+        return EINA_FALSE;
+
+      default:
+        break;
+     }
+
+   switch (c)
+     {
+      case ' ': case '\t': case '\n': case '\r':
+        break;
+      case '{': _push(t, '{', JSON_TOKEN_OBJECT_START); break;
+      case '[': _push(t, '[', JSON_TOKEN_ARRAY_START); break;
+      case '}': _pop(t, '{', JSON_TOKEN_OBJECT_END); break;
+      case ']': _pop(t, '[', JSON_TOKEN_ARRAY_END); break;
+      case ',':
+        t->expect_key = (t->depth > 0 && t->stack[t->depth - 1] == '{');
+        break;
+      case ':':
+        t->expect_key = EINA_FALSE;
+        break;
+      case '"':
+        t->state = STATE_STRING;
+        t->len = 0;
+        t->high_surrogate = 0;
+        break;
+      default:
+        if (c == '-' || (c >= '0' && c <= '9'))
+          {
+             t->state = STATE_NUMBER;
+             t->len = 0;
+             _append(t, c);
+          }
+        else if (c == 't' || c == 'f' || c == 'n')
+          {
+             t->state = STATE_LITERAL;
+             t->len = 0;
+             _append(t, c);
+          }
+        else
+          t->error = EINA_TRUE;
+     }
+   return EINA_TRUE;
+}
+
+Eina_Bool
+json_tokenizer_feed(Json_Tokenizer *t, const char *buf, size_t len)
+{
+   size_t i = 0;
+
+   while (i < len && !t->error)
+     {
+        if (_step(t, buf[i]))
+          i++;
+     }
+   return !t->error;
+}
+
+Eina_Bool
+json_tokenizer_finish(Json_Tokenizer *t)
+{
+   if (t->error) return EINA_FALSE;
+
+   if (t->state == STATE_NUMBER)
+     {
+        t->state = STATE_VALUE;
+        _emit(t, JSON_TOKEN_NUMBER);
+     }
+   else if (t->state == STATE_LITERAL)
+     {
+        t->state = STATE_VALUE;
+        _emit_literal(t);
+     }
+
+   return !t->error && t->state == STATE_VALUE && t->depth == 0;
+}
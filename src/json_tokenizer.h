@@ -0,0 +1,53 @@
+#pragma once
+
+#include <Eina.h>
+
+// Longest string or number token kept; longer values are truncated
+#define JSON_TOKEN_MAX 2048
+// Deepest container nesting tracked
+#define JSON_MAX_DEPTH 32
+
+typedef enum {
+   JSON_TOKEN_OBJECT_START,
+   JSON_TOKEN_OBJECT_END,
+   JSON_TOKEN_ARRAY_START,
+   JSON_TOKEN_ARRAY_END,
+   JSON_TOKEN_KEY,
+   JSON_TOKEN_STRING,
+   JSON_TOKEN_NUMBER,
+   JSON_TOKEN_TRUE,
+   JSON_TOKEN_FALSE,
+   JSON_TOKEN_NULL
+} Json_Token_Type;
+
+// text is NUL-terminated and only valid for the duration of the call.
+// depth counts the containers open at the token, including one being
+// started or ended by it.
+typedef void (*Json_Token_Cb)(void *data, Json_Token_Type type, const char *text, size_t len, int depth);
+
+// Streaming JSON tokenizer. All state lives in the struct, so it can be
+// embedded anywhere and never allocates; input may be split at any byte.
+typedef struct _Json_Tokenizer
+{
+   int state;
+   int depth;
+   char stack[JSON_MAX_DEPTH];   // '{' or '[' per open container
+   Eina_Bool expect_key;
+   Eina_Bool error;
+   char buf[JSON_TOKEN_MAX];
+   size_t len;
+   unsigned int codepoint;       // \uXXXX escape being decoded
+   int hex_digits;
+   unsigned int high_surrogate;
+   Json_Token_Cb cb;
+   void *data;
+} Json_Tokenizer;
+
+void json_tokenizer_init(Json_Tokenizer *t, Json_Token_Cb cb, const void *data);
+
+// Returns EINA_FALSE once malformed input has been seen
+Eina_Bool json_tokenizer_feed(Json_Tokenizer *t, const char *buf, size_t len);
+
+// Flush a trailing bare number or literal; returns EINA_FALSE if the input
+// was malformed or ended inside a string or container
+Eina_Bool json_tokenizer_finish(Json_Tokenizer *t);
@@ -3,6 +3,8 @@
 #include "radio_player.h"
 #include "http.h"
 #include "favorites.h"
+#include "favicon.h"
+#include "thumbs.h"
 #include "visualizer.h"
 
 EAPI_MAIN int
@@ -13,15 +15,19 @@ elm_main(int argc, char **argv)
    elm_policy_set(ELM_POLICY_QUIT, ELM_POLICY_QUIT_LAST_WINDOW_CLOSED);
 
    ui_create(&ad);
+   thumbs_init(ad.win);
    favorites_init(&ad);
    favorites_load(&ad);
    http_init(&ad);
+   favicon_init(&ad);
    ui_update_server_list(&ad);
    radio_player_init(&ad);
    visualizer_init(&ad);
 
    elm_run();
 
+   favicon_shutdown();
+   thumbs_shutdown();
    http_shutdown();
    radio_player_shutdown();
    visualizer_shutdown(&ad);
@@ -1,4 +1,5 @@
 #include "radio_player.h"
+#include "station_list.h"
 #include "ui.h"
 #include "visualizer.h"
 
@@ -200,6 +201,8 @@ radio_player_stop(AppData *ad)
         audio_progress_timer = NULL;
      }
 
+   station_list_now_playing_set(ad, NULL);
+
    // Clean up station name
    if (current_station_name)
      {
@@ -234,6 +237,14 @@ radio_player_toggle_pause(AppData *ad)
      }
 }
 
+Eina_Bool
+radio_player_is_starting(void)
+{
+   // The progress timer runs from radio_player_play() until audio is
+   // detected, the stream times out or playback is stopped
+   return audio_progress_timer != NULL;
+}
+
 void
 _play_pause_btn_clicked_cb(void *data, Evas_Object *obj, void *event_info)
 {
@@ -7,3 +7,6 @@ void radio_player_shutdown(void);
 void radio_player_play(AppData *ad, const char *url, const char *station_name);
 void radio_player_stop(AppData *ad);
 void radio_player_toggle_pause(AppData *ad);
+
+// A stream has been started but has not produced audio yet
+Eina_Bool radio_player_is_starting(void);
@@ -0,0 +1,173 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "result_cache.h"
+#include "station_parser.h"
+
+#define RESULT_CACHE_MAX_SETS 8
+#define RESULT_CACHE_DEFAULT_MB 16
+
+typedef struct _Result_Set
+{
+   char *key;
+   Eina_List *stations;
+   size_t bytes;
+   int offset;
+   Eina_Bool has_more;
+} Result_Set;
+
+static Eina_List *_sets = NULL;   // most recently used first
+static size_t _bytes = 0;
+static unsigned int _hits = 0;
+static unsigned int _misses = 0;
+
+static size_t
+_budget_get(void)
+{
+   const char *mb = getenv("ERADIO_RESULT_CACHE_MB");
+   int n = (mb && mb[0]) ? atoi(mb) : RESULT_CACHE_DEFAULT_MB;
+   if (n < 0) n = 0;
+   return (size_t)n * 1024 * 1024;
+}
+
+static size_t
+_str_size(const char *s)
+{
+   return s ? strlen(s) + 1 : 0;
+}
+
+// Estimated footprint of a result set; stringshares are counted as if
+// they were not shared, which errs on the side of evicting early
+static size_t
+_stations_size(Eina_List *stations)
+{
+   Eina_List *l;
+   Station *st;
+   size_t size = 0;
+
+   EINA_LIST_FOREACH(stations, l, st)
+     {
+        size += sizeof(Station) + sizeof(Eina_List);
+        size += _str_size(st->name) + _str_size(st->url) + _str_size(st->favicon);
+        size += _str_size(st->stationuuid) + _str_size(st->country);
+        size += _str_size(st->language) + _str_size(st->codec) + _str_size(st->tags);
+        size += _str_size(st->label);
+     }
+   return size;
+}
+
+static void
+_set_free(Result_Set *set)
+{
+   Station *st;
+
+   EINA_LIST_FREE(set->stations, st)
+     station_free(st);
+   free(set->key);
+   free(set);
+}
+
+static Result_Set *
+_set_remove(const char *key)
+{
+   Eina_List *l;
+   Result_Set *set;
+
+   EINA_LIST_FOREACH(_sets, l, set)
+     {
+        if (strcmp(set->key, key) != 0) continue;
+        _sets = eina_list_remove_list(_sets, l);
+        _bytes -= set->bytes;
+        return set;
+     }
+   return NULL;
+}
+
+void
+result_cache_put(const char *key, Eina_List *stations, int offset, Eina_Bool has_more)
+{
+   size_t budget = _budget_get();
+   Result_Set *set, *old;
+
+   if (!key || !key[0] || !stations) goto drop;
+
+   set = calloc(1, sizeof(Result_Set));
+   if (!set) goto drop;
+   set->key = strdup(key);
+   set->stations = stations;
+   set->bytes = _stations_size(stations);
+   set->offset = offset;
+   set->has_more = has_more;
+
+   // A set that can never fit is not worth evicting everything else for
+   if (!set->key || set->bytes > budget)
+     {
+        _set_free(set);
+        return;
+     }
+
+   old = _set_remove(key);
+   if (old) _set_free(old);
+
+   _sets = eina_list_prepend(_sets, set);
+   _bytes += set->bytes;
+
+   // Evict from the tail; the set just added is never evicted here
+   while (eina_list_count(_sets) > RESULT_CACHE_MAX_SETS || _bytes > budget)
+     {
+        Eina_List *last = eina_list_last(_sets);
+        old = eina_list_data_get(last);
+        if (old == set) break;
+        _sets = eina_list_remove_list(_sets, last);
+        _bytes -= old->bytes;
+        _set_free(old);
+     }
+   return;
+
+drop:
+   {
+      Station *st;
+      EINA_LIST_FREE(stations, st)
+        station_free(st);
+   }
+}
+
+Eina_List *
+result_cache_take(const char *key, int *offset, Eina_Bool *has_more)
+{
+   Result_Set *set = _set_remove(key);
+   Eina_List *stations;
+
+   if (!set)
+     {
+        _misses++;
+        return NULL;
+     }
+
+   _hits++;
+   stations = set->stations;
+   if (offset) *offset = set->offset;
+   if (has_more) *has_more = set->has_more;
+   set->stations = NULL;
+   _set_free(set);
+   return stations;
+}
+
+void
+result_cache_stats_get(unsigned int *hits, unsigned int *misses, unsigned int *sets, size_t *bytes)
+{
+   if (hits) *hits = _hits;
+   if (misses) *misses = _misses;
+   if (sets) *sets = eina_list_count(_sets);
+   if (bytes) *bytes = _bytes;
+}
+
+void
+result_cache_shutdown(void)
+{
+   Result_Set *set;
+
+   EINA_LIST_FREE(_sets, set)
+     _set_free(set);
+   _bytes = 0;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "appdata.h"
+
+// Bounded in-memory LRU of recently shown search result sets, so flipping
+// back to a recent query needs no network or parse work. Bounded both by
+// number of sets and by their estimated size
+// (ERADIO_RESULT_CACHE_MB, default 16).
+
+// Hand a result set to the cache; the cache owns stations afterwards.
+// offset and has_more restore the paging state on a later hit.
+void result_cache_put(const char *key, Eina_List *stations, int offset, Eina_Bool has_more);
+
+// Take the result set stored under key back out of the cache, or NULL on
+// a miss. Counts towards the hit/miss statistics.
+Eina_List *result_cache_take(const char *key, int *offset, Eina_Bool *has_more);
+
+// Lookups since startup and what the cache holds now
+void result_cache_stats_get(unsigned int *hits, unsigned int *misses, unsigned int *sets, size_t *bytes);
+
+void result_cache_shutdown(void);
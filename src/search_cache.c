@@ -0,0 +1,324 @@
+#include <Ecore_File.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+#include "search_cache.h"
+
+#define SEARCH_CACHE_DEFAULT_TTL (15 * 60)
+#define SEARCH_CACHE_DEFAULT_MB 10
+#define SEARCH_CACHE_MAX_ENTRIES 2000
+
+typedef struct _Usage_Entry
+{
+   char *name;             // file name without suffix
+   time_t used;            // mtime of the meta file
+   size_t size;
+} Usage_Entry;
+
+static Eina_Bool _scanned = EINA_FALSE;
+static size_t _total = 0;               // bytes in .body files
+static unsigned int _files = 0;         // entries
+
+static Eina_Bool
+_cache_dir_get(char *buf, size_t len)
+{
+   const char *home = getenv("HOME");
+   if (!home) return EINA_FALSE;
+   snprintf(buf, len, "%s/.cache/eradio/search", home);
+   return EINA_TRUE;
+}
+
+// Entries are stored as <hash>.meta and <hash>.body; the meta file repeats
+// the full key so that hash collisions read as misses.
+static Eina_Bool
+_cache_path_get(char *buf, size_t len, const char *key, const char *suffix)
+{
+   char dir[PATH_MAX];
+   unsigned long long hash = 1469598103934665603ULL;   // FNV-1a 64
+
+   if (!_cache_dir_get(dir, sizeof(dir))) return EINA_FALSE;
+   for (const unsigned char *p = (const unsigned char *)key; *p; p++)
+     {
+        hash ^= *p;
+        hash *= 1099511628211ULL;
+     }
+   snprintf(buf, len, "%s/%016llx.%s", dir, hash, suffix);
+   return EINA_TRUE;
+}
+
+void
+search_cache_key_build(char *buf, size_t len, ApiFormat format,
+                       const char *search_type, const char *search_term,
+                       const char *order, Eina_Bool reverse, int offset, int limit)
+{
+   char term[512];
+   size_t n = 0;
+   Eina_Bool space = EINA_FALSE;
+
+   for (const char *p = search_term ? search_term : ""; *p && n < sizeof(term) - 1; p++)
+     {
+        if (isspace((unsigned char)*p))
+          {
+             space = (n > 0);
+             continue;
+          }
+        if (space && n < sizeof(term) - 2) term[n++] = ' ';
+        space = EINA_FALSE;
+        term[n++] = tolower((unsigned char)*p);
+     }
+   term[n] = '\0';
+
+   snprintf(buf, len, "%s|%s=%s|%s|%d|%d|%d",
+            format == API_FORMAT_JSON ? "json" : "xml",
+            search_type ? search_type : "name", term, order ? order : "name",
+            reverse ? 1 : 0, offset, limit);
+}
+
+static void
+_line_read(FILE *f, char *buf, size_t len)
+{
+   buf[0] = '\0';
+   if (!fgets(buf, len, f)) return;
+   buf[strcspn(buf, "\r\n")] = '\0';
+}
+
+static Eina_Bool
+_meta_write(const char *key, time_t fetched, const char *etag, const char *last_modified)
+{
+   char path[PATH_MAX], tmp[PATH_MAX + 8];
+   FILE *f;
+
+   if (!_cache_path_get(path, sizeof(path), key, "meta")) return EINA_FALSE;
+   snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+   f = fopen(tmp, "w");
+   if (!f) return EINA_FALSE;
+   fprintf(f, "%s\n%lld\n%s\n%s\n", key, (long long)fetched,
+           etag ? etag : "", last_modified ? last_modified : "");
+   if (fclose(f) != 0 || rename(tmp, path) == -1)
+     {
+        unlink(tmp);
+        return EINA_FALSE;
+     }
+   return EINA_TRUE;
+}
+
+static Eina_Bool
+_meta_read(const char *key, Search_Cache_Entry *e)
+{
+   char path[PATH_MAX], line[2048];
+   FILE *f;
+
+   if (!_cache_path_get(path, sizeof(path), key, "meta")) return EINA_FALSE;
+   f = fopen(path, "r");
+   if (!f) return EINA_FALSE;
+
+   _line_read(f, line, sizeof(line));
+   if (strcmp(line, key) != 0)
+     {
+        fclose(f);
+        return EINA_FALSE;
+     }
+   _line_read(f, line, sizeof(line));
+   e->fetched = (time_t)atoll(line);
+   _line_read(f, e->etag, sizeof(e->etag));
+   _line_read(f, e->last_modified, sizeof(e->last_modified));
+   fclose(f);
+   return EINA_TRUE;
+}
+
+static size_t
+_budget_get(void)
+{
+   const char *mb = getenv("ERADIO_SEARCH_CACHE_MB");
+   return (size_t)((mb && atoi(mb) > 0) ? atoi(mb) : SEARCH_CACHE_DEFAULT_MB) * 1024 * 1024;
+}
+
+static int
+_used_cmp(const void *a, const void *b)
+{
+   const Usage_Entry *ea = a, *eb = b;
+   return (ea->used > eb->used) - (ea->used < eb->used);
+}
+
+// Every entry in the directory with its size and last use, and the totals
+static Eina_List *
+_usage_scan(const char *dir)
+{
+   Eina_List *files = ecore_file_ls(dir), *entries = NULL;
+   char *name, path[PATH_MAX];
+   struct stat meta, body;
+
+   _total = 0;
+   _files = 0;
+   EINA_LIST_FREE(files, name)
+     {
+        char *dot = strrchr(name, '.');
+        Usage_Entry *e;
+
+        if (dot && !strcmp(dot, ".meta"))
+          {
+             snprintf(path, sizeof(path), "%s/%s", dir, name);
+             if (stat(path, &meta) == 0 && (e = calloc(1, sizeof(Usage_Entry))))
+               {
+                  *dot = '\0';
+                  snprintf(path, sizeof(path), "%s/%s.body", dir, name);
+                  e->name = strdup(name);
+                  e->used = meta.st_mtime;
+                  e->size = (stat(path, &body) == 0) ? (size_t)body.st_size : 0;
+                  _total += e->size;
+                  _files++;
+                  entries = eina_list_append(entries, e);
+               }
+          }
+        free(name);
+     }
+   _scanned = EINA_TRUE;
+   return entries;
+}
+
+// Remove the least recently used entries down to 90% of the byte budget
+// and of the entry limit, so a full cache does not evict on every page
+static void
+_evict(const char *dir)
+{
+   size_t budget = _budget_get();
+   Eina_List *entries = _usage_scan(dir);
+   Usage_Entry *e;
+   char path[PATH_MAX];
+   int evicted = 0;
+
+   entries = eina_list_sort(entries, 0, _used_cmp);
+   EINA_LIST_FREE(entries, e)
+     {
+        if (_total > budget / 10 * 9 || _files > SEARCH_CACHE_MAX_ENTRIES / 10 * 9)
+          {
+             snprintf(path, sizeof(path), "%s/%s.meta", dir, e->name);
+             unlink(path);
+             snprintf(path, sizeof(path), "%s/%s.body", dir, e->name);
+             unlink(path);
+             _total -= e->size;
+             _files--;
+             evicted++;
+          }
+        free(e->name);
+        free(e);
+     }
+   printf("Search cache: evicted %d entries, %zu of %zu bytes used\n", evicted, _total, budget);
+}
+
+static void
+_usage_add(const char *dir, size_t old_size, Eina_Bool existed, size_t size)
+{
+   if (!_scanned)
+     {
+        Usage_Entry *e;
+        Eina_List *entries = _usage_scan(dir);
+        EINA_LIST_FREE(entries, e)
+          {
+             free(e->name);
+             free(e);
+          }
+     }
+   else
+     {
+        _total = _total - old_size + size;
+        if (!existed) _files++;
+     }
+   if (_total > _budget_get() || _files > SEARCH_CACHE_MAX_ENTRIES)
+     _evict(dir);
+}
+
+Search_Cache_Entry *
+search_cache_get(const char *key)
+{
+   char path[PATH_MAX];
+   Search_Cache_Entry *e;
+   FILE *f;
+   long size;
+
+   e = calloc(1, sizeof(Search_Cache_Entry));
+   if (!e) return NULL;
+   if (!_meta_read(key, e)) goto fail;
+
+   if (!_cache_path_get(path, sizeof(path), key, "body")) goto fail;
+   f = fopen(path, "rb");
+   if (!f) goto fail;
+   fseek(f, 0, SEEK_END);
+   size = ftell(f);
+   fseek(f, 0, SEEK_SET);
+   e->body = malloc(size > 0 ? size : 1);
+   if (!e->body || fread(e->body, 1, size, f) != (size_t)size)
+     {
+        fclose(f);
+        goto fail;
+     }
+   e->size = size;
+   fclose(f);
+   // The meta file's mtime is the entry's last use for eviction
+   if (_cache_path_get(path, sizeof(path), key, "meta"))
+     utime(path, NULL);
+   return e;
+
+fail:
+   search_cache_entry_free(e);
+   return NULL;
+}
+
+void
+search_cache_entry_free(Search_Cache_Entry *e)
+{
+   if (!e) return;
+   free(e->body);
+   free(e);
+}
+
+void
+search_cache_put(const char *key, const void *body, size_t size,
+                 const char *etag, const char *last_modified)
+{
+   char dir[PATH_MAX], path[PATH_MAX], tmp[PATH_MAX + 8];
+   struct stat old;
+   Eina_Bool existed;
+   FILE *f;
+
+   if (!_cache_dir_get(dir, sizeof(dir))) return;
+   ecore_file_mkpath(dir);
+
+   if (!_cache_path_get(path, sizeof(path), key, "body")) return;
+   snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+   existed = stat(path, &old) == 0;
+
+   f = fopen(tmp, "wb");
+   if (!f) return;
+   size_t written = fwrite(body, 1, size, f);
+   if (fclose(f) != 0 || written != size || rename(tmp, path) == -1)
+     {
+        unlink(tmp);
+        return;
+     }
+
+   _meta_write(key, time(NULL), etag, last_modified);
+   _usage_add(dir, existed ? (size_t)old.st_size : 0, existed, size);
+}
+
+void
+search_cache_touch(const char *key)
+{
+   Search_Cache_Entry e = {0};
+   if (!_meta_read(key, &e)) return;
+   _meta_write(key, time(NULL), e.etag, e.last_modified);
+}
+
+int
+search_cache_ttl_get(void)
+{
+   const char *ttl = getenv("ERADIO_SEARCH_CACHE_TTL");
+   if (ttl && ttl[0]) return atoi(ttl);
+   return SEARCH_CACHE_DEFAULT_TTL;
+}
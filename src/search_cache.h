@@ -0,0 +1,39 @@
+#pragma once
+
+#include "appdata.h"
+
+// A cached search response body and the validators it was served with
+typedef struct _Search_Cache_Entry
+{
+   char *body;
+   size_t size;
+   time_t fetched;          // when the body was stored or last revalidated
+   char etag[256];
+   char last_modified[64];
+} Search_Cache_Entry;
+
+// Build the cache key for one page of a search. The API mirrors serve the
+// same data, so the server is not part of it. The search term is
+// normalized (trimmed, lowercased, whitespace collapsed) so equivalent
+// queries share an entry.
+void search_cache_key_build(char *buf, size_t len, ApiFormat format,
+                            const char *search_type, const char *search_term,
+                            const char *order, Eina_Bool reverse, int offset, int limit);
+
+// Load the entry for key from ~/.cache/eradio/search, or NULL on a miss.
+// The directory is kept under a byte budget (ERADIO_SEARCH_CACHE_MB,
+// default 10) and an entry limit by evicting the least recently used
+// entries.
+Search_Cache_Entry *search_cache_get(const char *key);
+void search_cache_entry_free(Search_Cache_Entry *e);
+
+// Store a response body under key, replacing any previous entry
+void search_cache_put(const char *key, const void *body, size_t size,
+                      const char *etag, const char *last_modified);
+
+// Mark the entry for key as revalidated now (server answered 304)
+void search_cache_touch(const char *key);
+
+// Seconds a cached response is served without revalidation
+// (ERADIO_SEARCH_CACHE_TTL, default 15 minutes)
+int search_cache_ttl_get(void);
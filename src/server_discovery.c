@@ -0,0 +1,318 @@
+#include <Ecore.h>
+#include <Ecore_File.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "server_discovery.h"
+#include "ui.h"
+
+#define DISCOVERY_HOST "all.api.radio-browser.info"
+#define DISCOVERY_MAX_ADDRS 32
+#define DISCOVERY_DEFAULT_INTERVAL (60 * 60)
+
+// One discovery round: a forward lookup, then one reverse lookup per
+// address, all on Ecore's thread pool so they run in parallel
+typedef struct _Discovery
+{
+   AppData *ad;               // NULL once abandoned at shutdown
+   struct sockaddr_storage addrs[DISCOVERY_MAX_ADDRS];
+   socklen_t addrlens[DISCOVERY_MAX_ADDRS];
+   int count;
+   int pending;               // threads that have not reported back
+   Eina_List *threads;
+   Eina_List *hosts;          // stringshared names found so far
+} Discovery;
+
+typedef struct _Reverse_Lookup
+{
+   Discovery *disc;
+   int index;
+   char host[NI_MAXHOST];
+} Reverse_Lookup;
+
+static Discovery *_current = NULL;
+static Ecore_Timer *_refresh_timer = NULL;
+
+static Eina_Bool
+_servers_path_get(char *buf, size_t len)
+{
+   const char *home = getenv("HOME");
+   if (!home) return EINA_FALSE;
+   snprintf(buf, len, "%s/.cache/eradio/servers", home);
+   return EINA_TRUE;
+}
+
+static Eina_Bool
+_hostname_valid(const char *host)
+{
+   if (!host[0]) return EINA_FALSE;
+   for (const char *p = host; *p; p++)
+     if (!isalnum((unsigned char)*p) && *p != '.' && *p != '-' && *p != ':')
+       return EINA_FALSE;
+   return EINA_TRUE;
+}
+
+// Servers are only ever appended: in-flight requests hold borrowed
+// pointers to the stringshares in ad->api_servers
+static Eina_Bool
+_add_unique_server(AppData *ad, const char *hostname)
+{
+   Eina_List *l;
+   const char *h;
+
+   if (!hostname || !_hostname_valid(hostname)) return EINA_FALSE;
+   EINA_LIST_FOREACH(ad->api_servers, l, h)
+     if (strcmp(h, hostname) == 0) return EINA_FALSE;
+   ad->api_servers = eina_list_append(ad->api_servers, eina_stringshare_add(hostname));
+   return EINA_TRUE;
+}
+
+static void
+_servers_load(AppData *ad)
+{
+   char path[PATH_MAX], line[NI_MAXHOST];
+   FILE *f;
+
+   if (!_servers_path_get(path, sizeof(path))) return;
+   f = fopen(path, "r");
+   if (!f) return;
+   while (fgets(line, sizeof(line), f))
+     {
+        line[strcspn(line, "\r\n")] = '\0';
+        _add_unique_server(ad, line);
+     }
+   fclose(f);
+   printf("Loaded %d API servers from %s\n", eina_list_count(ad->api_servers), path);
+}
+
+// Only the latest discovery is saved, so mirrors that have been retired
+// drop out on the next start
+static void
+_servers_save(const Eina_List *hosts)
+{
+   char path[PATH_MAX], tmp[PATH_MAX + 8];
+   const Eina_List *l;
+   const char *h;
+   char *dir;
+   FILE *f;
+
+   if (!_servers_path_get(path, sizeof(path))) return;
+   dir = ecore_file_dir_get(path);
+   if (dir)
+     {
+        ecore_file_mkpath(dir);
+        free(dir);
+     }
+
+   snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+   f = fopen(tmp, "w");
+   if (!f) return;
+   EINA_LIST_FOREACH(hosts, l, h)
+     fprintf(f, "%s\n", h);
+   if (fclose(f) != 0 || rename(tmp, path) == -1)
+     unlink(tmp);
+}
+
+static void
+_discovery_free(Discovery *disc)
+{
+   const char *h;
+
+   EINA_LIST_FREE(disc->hosts, h)
+     eina_stringshare_del(h);
+   eina_list_free(disc->threads);
+   if (_current == disc) _current = NULL;
+   free(disc);
+}
+
+static void
+_discovery_finish(Discovery *disc)
+{
+   AppData *ad = disc->ad;
+   const Eina_List *l;
+   const char *h;
+   int added = 0;
+
+   if (ad && disc->hosts)
+     {
+        EINA_LIST_FOREACH(disc->hosts, l, h)
+          if (_add_unique_server(ad, h)) added++;
+        printf("Discovered %d API servers (%d new)\n", eina_list_count(disc->hosts), added);
+        _servers_save(disc->hosts);
+        if (added) ui_update_server_list(ad);
+     }
+   else if (ad)
+     printf("API server discovery found no servers; keeping %d known\n",
+            eina_list_count(ad->api_servers));
+   _discovery_free(disc);
+}
+
+// A thread reported back (finished or cancelled)
+static void
+_discovery_thread_done(Discovery *disc, Ecore_Thread *thread)
+{
+   disc->threads = eina_list_remove(disc->threads, thread);
+   if (--disc->pending == 0)
+     _discovery_finish(disc);
+}
+
+static void
+_reverse_blocking(void *data, Ecore_Thread *thread EINA_UNUSED)
+{
+   Reverse_Lookup *rl = data;
+   Discovery *disc = rl->disc;
+   const struct sockaddr *addr = (const struct sockaddr *)&disc->addrs[rl->index];
+   socklen_t len = disc->addrlens[rl->index];
+
+   // Reverse DNS gives the human-readable mirror name; fall back to the
+   // numeric address if there is none
+   if (getnameinfo(addr, len, rl->host, sizeof(rl->host), NULL, 0, NI_NAMEREQD) != 0 &&
+       getnameinfo(addr, len, rl->host, sizeof(rl->host), NULL, 0, NI_NUMERICHOST) != 0)
+     rl->host[0] = '\0';
+}
+
+static void
+_reverse_end(void *data, Ecore_Thread *thread)
+{
+   Reverse_Lookup *rl = data;
+   Discovery *disc = rl->disc;
+
+   if (rl->host[0] && !eina_list_search_unsorted(disc->hosts, EINA_COMPARE_CB(strcmp), rl->host))
+     disc->hosts = eina_list_append(disc->hosts, eina_stringshare_add(rl->host));
+   free(rl);
+   _discovery_thread_done(disc, thread);
+}
+
+static void
+_reverse_cancel(void *data, Ecore_Thread *thread)
+{
+   Reverse_Lookup *rl = data;
+   Discovery *disc = rl->disc;
+
+   free(rl);
+   _discovery_thread_done(disc, thread);
+}
+
+static void
+_resolve_blocking(void *data, Ecore_Thread *thread EINA_UNUSED)
+{
+   Discovery *disc = data;
+   struct addrinfo hints = {0}, *res = NULL, *p;
+   int ret;
+
+   hints.ai_family = AF_UNSPEC;
+   hints.ai_socktype = SOCK_STREAM;
+   ret = getaddrinfo(DISCOVERY_HOST, NULL, &hints, &res);
+   if (ret != 0)
+     {
+        printf("DNS lookup failed: %s\n", gai_strerror(ret));
+        return;
+     }
+
+   for (p = res; p && disc->count < DISCOVERY_MAX_ADDRS; p = p->ai_next)
+     {
+        if (p->ai_addrlen > sizeof(disc->addrs[0])) continue;
+        memcpy(&disc->addrs[disc->count], p->ai_addr, p->ai_addrlen);
+        disc->addrlens[disc->count] = p->ai_addrlen;
+        disc->count++;
+     }
+   freeaddrinfo(res);
+}
+
+static void
+_resolve_end(void *data, Ecore_Thread *thread)
+{
+   Discovery *disc = data;
+
+   disc->threads = eina_list_remove(disc->threads, thread);
+   if (!disc->ad)
+     {
+        _discovery_free(disc);
+        return;
+     }
+
+   // The forward lookup keeps its pending slot until every reverse lookup
+   // is queued, as a thread that fails to start reports back immediately
+   for (int i = 0; i < disc->count; i++)
+     {
+        Reverse_Lookup *rl = calloc(1, sizeof(Reverse_Lookup));
+        Ecore_Thread *t;
+
+        if (!rl) continue;
+        rl->disc = disc;
+        rl->index = i;
+        disc->pending++;
+        t = ecore_thread_run(_reverse_blocking, _reverse_end, _reverse_cancel, rl);
+        if (t) disc->threads = eina_list_append(disc->threads, t);
+     }
+
+   if (--disc->pending == 0)
+     _discovery_finish(disc);
+}
+
+static void
+_resolve_cancel(void *data, Ecore_Thread *thread EINA_UNUSED)
+{
+   _discovery_free(data);
+}
+
+static void
+_discovery_run(AppData *ad)
+{
+   Discovery *disc;
+   Ecore_Thread *t;
+
+   if (_current) return;   // previous round still running
+   disc = calloc(1, sizeof(Discovery));
+   if (!disc) return;
+   disc->ad = ad;
+   disc->pending = 1;
+   _current = disc;
+   t = ecore_thread_run(_resolve_blocking, _resolve_end, _resolve_cancel, disc);
+   if (t) disc->threads = eina_list_append(disc->threads, t);
+}
+
+static Eina_Bool
+_refresh_timer_cb(void *data)
+{
+   _discovery_run(data);
+   return ECORE_CALLBACK_RENEW;
+}
+
+void
+server_discovery_start(AppData *ad)
+{
+   const char *interval_env = getenv("ERADIO_SERVER_REFRESH");
+   double interval = DISCOVERY_DEFAULT_INTERVAL;
+
+   if (interval_env && atof(interval_env) > 0) interval = atof(interval_env);
+
+   _servers_load(ad);
+   _discovery_run(ad);
+   _refresh_timer = ecore_timer_add(interval, _refresh_timer_cb, ad);
+}
+
+void
+server_discovery_shutdown(void)
+{
+   Eina_List *threads;
+   Ecore_Thread *t;
+
+   if (_refresh_timer) ecore_timer_del(_refresh_timer);
+   _refresh_timer = NULL;
+   if (!_current) return;
+
+   // Callbacks of cancelled threads must not touch AppData any more; the
+   // last one to report back frees the round
+   _current->ad = NULL;
+   threads = _current->threads;
+   _current->threads = NULL;
+   _current = NULL;
+   EINA_LIST_FREE(threads, t)
+     ecore_thread_cancel(t);
+}
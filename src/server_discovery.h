@@ -0,0 +1,12 @@
+#pragma once
+
+#include "appdata.h"
+
+// Fill ad->api_servers from the list saved by the previous run, then look up
+// all.api.radio-browser.info in the background. The lookup is repeated
+// every ERADIO_SERVER_REFRESH seconds (default one hour); new mirrors are
+// appended to ad->api_servers and the server picker is refreshed.
+void server_discovery_start(AppData *ad);
+
+// Stop the refresh timer and abandon lookups still running
+void server_discovery_shutdown(void);
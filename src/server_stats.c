@@ -0,0 +1,209 @@
+#include <Ecore.h>
+#include <Ecore_File.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "server_stats.h"
+
+#define TTFB_ALPHA 0.3
+#define FAILURE_ALPHA 0.2
+#define UNKNOWN_TTFB 0.8           // assumed for servers never measured
+#define FAILURE_PENALTY 3.0        // a server failing every time scores 4x slower
+#define BREAKER_THRESHOLD 3        // consecutive failures that open the circuit
+#define BREAKER_BASE_BACKOFF 30    // seconds, doubled per further failure
+#define BREAKER_MAX_BACKOFF (30 * 60)
+#define STATS_SAVE_DELAY 5.0       // seconds to batch saves
+
+typedef struct _Server_Stats
+{
+   double ttfb;            // EWMA of seconds to first byte, 0 if never measured
+   double failure_rate;    // EWMA of 0 (success) / 1 (failure)
+   int consecutive_failures;
+   time_t open_until;      // circuit open (server skipped) until this time
+} Server_Stats;
+
+static Eina_Hash *_stats = NULL;
+static Ecore_Timer *_save_timer = NULL;
+
+static Eina_Bool
+_stats_path_get(char *buf, size_t len)
+{
+   const char *home = getenv("HOME");
+   if (!home) return EINA_FALSE;
+   snprintf(buf, len, "%s/.cache/eradio/server_stats", home);
+   return EINA_TRUE;
+}
+
+static Server_Stats *
+_stats_get(const char *host, Eina_Bool create)
+{
+   Server_Stats *s;
+
+   if (!host) return NULL;
+   if (!_stats) _stats = eina_hash_string_superfast_new(free);
+   s = eina_hash_find(_stats, host);
+   if (s || !create) return s;
+
+   s = calloc(1, sizeof(Server_Stats));
+   if (!s) return NULL;
+   eina_hash_add(_stats, host, s);
+   return s;
+}
+
+void
+server_stats_load(void)
+{
+   char path[PATH_MAX], line[1024], host[512];
+   FILE *f;
+
+   if (!_stats_path_get(path, sizeof(path))) return;
+   f = fopen(path, "r");
+   if (!f) return;
+
+   while (fgets(line, sizeof(line), f))
+     {
+        Server_Stats tmp = {0};
+        long long open_until = 0;
+        Server_Stats *s;
+
+        if (sscanf(line, "%511s %lf %lf %d %lld", host, &tmp.ttfb, &tmp.failure_rate,
+                   &tmp.consecutive_failures, &open_until) != 5)
+          continue;
+        s = _stats_get(host, EINA_TRUE);
+        if (!s) continue;
+        *s = tmp;
+        s->open_until = (time_t)open_until;
+     }
+   fclose(f);
+}
+
+static Eina_Bool
+_stats_write_cb(const Eina_Hash *hash EINA_UNUSED, const void *key, void *data, void *fdata)
+{
+   const Server_Stats *s = data;
+   fprintf(fdata, "%s %.4f %.4f %d %lld\n", (const char *)key, s->ttfb, s->failure_rate,
+           s->consecutive_failures, (long long)s->open_until);
+   return EINA_TRUE;
+}
+
+static void
+_stats_save(void)
+{
+   char path[PATH_MAX], tmp[PATH_MAX + 8];
+   char *dir;
+   FILE *f;
+
+   if (!_stats || !_stats_path_get(path, sizeof(path))) return;
+   dir = ecore_file_dir_get(path);
+   if (dir)
+     {
+        ecore_file_mkpath(dir);
+        free(dir);
+     }
+
+   snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+   f = fopen(tmp, "w");
+   if (!f) return;
+   eina_hash_foreach(_stats, _stats_write_cb, f);
+   if (fclose(f) != 0 || rename(tmp, path) == -1)
+     unlink(tmp);
+}
+
+static Eina_Bool
+_save_timer_cb(void *data EINA_UNUSED)
+{
+   _save_timer = NULL;
+   _stats_save();
+   return ECORE_CALLBACK_CANCEL;
+}
+
+// Saved shortly after each change, so a crash keeps what was learned
+static void
+_mark_dirty(void)
+{
+   if (!_save_timer)
+     _save_timer = ecore_timer_add(STATS_SAVE_DELAY, _save_timer_cb, NULL);
+}
+
+void
+server_stats_shutdown(void)
+{
+   if (_save_timer) ecore_timer_del(_save_timer);
+   _save_timer = NULL;
+   _stats_save();
+   if (_stats) eina_hash_free(_stats);
+   _stats = NULL;
+}
+
+void
+server_stats_success(const char *host, double ttfb)
+{
+   Server_Stats *s = _stats_get(host, EINA_TRUE);
+   if (!s) return;
+
+   if (ttfb >= 0.0)
+     s->ttfb = (s->ttfb > 0.0) ? s->ttfb + TTFB_ALPHA * (ttfb - s->ttfb) : ttfb;
+   s->failure_rate -= FAILURE_ALPHA * s->failure_rate;
+   s->consecutive_failures = 0;
+   s->open_until = 0;
+   _mark_dirty();
+}
+
+void
+server_stats_failure(const char *host)
+{
+   Server_Stats *s = _stats_get(host, EINA_TRUE);
+   if (!s) return;
+
+   s->failure_rate += FAILURE_ALPHA * (1.0 - s->failure_rate);
+   s->consecutive_failures++;
+   if (s->consecutive_failures >= BREAKER_THRESHOLD)
+     {
+        int shift = s->consecutive_failures - BREAKER_THRESHOLD;
+        long backoff = BREAKER_MAX_BACKOFF;
+
+        if (shift < 16 && ((long)BREAKER_BASE_BACKOFF << shift) < BREAKER_MAX_BACKOFF)
+          backoff = (long)BREAKER_BASE_BACKOFF << shift;
+        s->open_until = time(NULL) + backoff;
+        printf("Server %s failed %d times in a row; skipping it for %lds\n",
+               host, s->consecutive_failures, backoff);
+     }
+   _mark_dirty();
+}
+
+static double
+_score(const char *host, time_t now)
+{
+   Server_Stats *s = _stats_get(host, EINA_FALSE);
+   double score;
+
+   if (!s) return UNKNOWN_TTFB;
+   score = (s->ttfb > 0.0 ? s->ttfb : UNKNOWN_TTFB) * (1.0 + FAILURE_PENALTY * s->failure_rate);
+   // Open circuits sort after every healthy server
+   if (s->open_until > now) score += 1e6;
+   return score;
+}
+
+static time_t _sort_now;
+
+static int
+_score_cmp(const void *a, const void *b)
+{
+   double sa = _score(a, _sort_now), sb = _score(b, _sort_now);
+   return (sa > sb) - (sa < sb);
+}
+
+Eina_List *
+server_stats_order(const Eina_List *servers)
+{
+   Eina_List *ordered = eina_list_clone(servers);
+
+   // Shuffle first so that equally scored (e.g. unmeasured) servers share
+   // the load; the merge sort below keeps their relative order
+   ordered = eina_list_shuffle(ordered, NULL);
+   _sort_now = time(NULL);
+   return eina_list_sort(ordered, 0, _score_cmp);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <Eina.h>
+
+// Per-mirror health learned from real requests: an EWMA of time-to-first-byte
+// and of the failure rate, plus a circuit breaker that benches a server after
+// repeated consecutive failures.
+
+// Load the stats saved by the previous run (~/.cache/eradio/server_stats)
+void server_stats_load(void);
+
+// Save the stats and release them. Changes are also saved a few seconds
+// after they happen.
+void server_stats_shutdown(void);
+
+// Record a request to host that started answering after ttfb seconds.
+// A negative ttfb records the success without a latency sample.
+void server_stats_success(const char *host, double ttfb);
+
+// Record a failed request (HTTP error, connection failure, bad response)
+void server_stats_failure(const char *host);
+
+// Return a new list with the hosts of servers, best first. Servers whose
+// circuit is open are moved behind all others so they are only tried when
+// everything else has failed. Unknown servers keep a random relative order.
+Eina_List *server_stats_order(const Eina_List *servers);
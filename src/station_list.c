@@ -3,87 +3,68 @@
 #include "radio_player.h"
 #include "http.h"
 #include "favorites.h"
+#include "favicon.h"
 #include "ui.h"
 
+#define POPULATE_FIRST_ROWS 40        // inserted at once: enough to fill the view
+#define POPULATE_SLICE_BUDGET 0.004   // seconds of row insertion per frame
+#define POPULATE_CHECK_ROWS 16        // rows between clock reads
+#define LARGE_LIST_ROWS 2000          // result sets from this size use the large-list mode
+#define LARGE_LIST_BLOCK_COUNT 128    // items per genlist block in that mode
+#define DEFAULT_BLOCK_COUNT 32        // genlist's own default
+
 static void _favorite_btn_clicked_cb(void *data, Evas_Object *obj, void *event_info);
 static void _favorite_remove_btn_clicked_cb(void *data, Evas_Object *obj, void *event_info);
 
+// Every row of the current population, so a station's row is found in
+// constant time instead of by walking the list
+static Eina_Hash *_items = NULL;                // Station * -> Elm_Object_Item *
+// The playing station is identified by UUID (or URL), so it stays marked
+// when the same station shows up again after another search
+static const char *_playing_key = NULL;         // stringshare
+static Elm_Object_Item *_playing_item = NULL;
+
+static const char *
+_station_play_key(const Station *st)
+{
+    return (st->stationuuid && st->stationuuid[0]) ? st->stationuuid : st->url;
+}
+
+static Eina_Bool
+_station_is_playing(const Station *st)
+{
+    // Both are stringshares, so pointers compare
+    return _playing_key && _station_play_key(st) == _playing_key;
+}
+
 static char *
 _gl_text_get(void *data, Evas_Object *obj, const char *part)
 {
     Station *st = data;
 
+    // The label is built once per station by station_label_update();
+    // genlist takes ownership of the returned copy
     if (!strcmp(part, "elm.text"))
     {
-        // Create a detailed text showing station name and metadata
-        char detailed_text[512] = {0};
-        snprintf(detailed_text, sizeof(detailed_text), "%s", st->name ? st->name : "");
-
-        // Add bitrate, codec, country as additional info
-        char info[256] = "";
-        Eina_Bool first_item = EINA_TRUE;
-
-        if (st->bitrate > 0)
-        {
-            char bitrate_str[32];
-            snprintf(bitrate_str, sizeof(bitrate_str), "%d kbps", st->bitrate);
-            size_t remaining = sizeof(info) - strlen(info);
-            snprintf(info + strlen(info), remaining, "%s", bitrate_str);
-            first_item = EINA_FALSE;
-        }
+        const char *label = st->label ? st->label : (st->name ? st->name : "");
+        char *text;
 
-        if (st->codec && st->codec[0])
-        {
-            if (!first_item) {
-                size_t remaining = sizeof(info) - strlen(info);
-                snprintf(info + strlen(info), remaining, " | ");
-            }
-            size_t remaining = sizeof(info) - strlen(info);
-            snprintf(info + strlen(info), remaining, "%s", st->codec);
-            first_item = EINA_FALSE;
-        }
-
-        if (st->country && st->country[0])
-        {
-            if (!first_item) {
-                size_t remaining = sizeof(info) - strlen(info);
-                snprintf(info + strlen(info), remaining, " | ");
-            }
-            size_t remaining = sizeof(info) - strlen(info);
-            snprintf(info + strlen(info), remaining, "%s", st->country);
-            first_item = EINA_FALSE;
-        }
-
-        if (st->language && st->language[0])
-        {
-            if (!first_item) {
-                size_t remaining = sizeof(info) - strlen(info);
-                snprintf(info + strlen(info), remaining, " | ");
-            }
-            size_t remaining = sizeof(info) - strlen(info);
-            snprintf(info + strlen(info), remaining, "%s", st->language);
-            first_item = EINA_FALSE;
-        }
-
-        if (info[0])
-        {
-            strncat(detailed_text, " • ", sizeof(detailed_text) - strlen(detailed_text) - 1);
-            strncat(detailed_text, info, sizeof(detailed_text) - strlen(detailed_text) - 1);
-        }
-
-        // Add tags on another line if available
-        if (st->tags && st->tags[0])
-        {
-            strncat(detailed_text, " • ", sizeof(detailed_text) - strlen(detailed_text) - 1);
-            strncat(detailed_text, st->tags, sizeof(detailed_text) - strlen(detailed_text) - 1);
-        }
-
-        return strdup(detailed_text);
+        if (!_station_is_playing(st)) return strdup(label);
+        text = malloc(strlen(label) + sizeof("▶ "));
+        if (text) sprintf(text, "▶ %s", label);
+        return text;
     }
 
     return NULL;
 }
 
+static const char *
+_end_button_text(const AppData *ad, const Station *st)
+{
+    if (ad->view_mode == VIEW_FAVORITES) return "Remove";
+    return st->favorite ? "★" : "☆";
+}
+
 static Evas_Object *
 _gl_content_get(void *data, Evas_Object *obj, const char *part)
 {
@@ -91,55 +72,70 @@ _gl_content_get(void *data, Evas_Object *obj, const char *part)
     AppData *ad = evas_object_data_get(obj, "ad");
     if (!strcmp(part, "elm.swallow.icon"))
     {
-        Evas_Object *icon = elm_icon_add(obj);
+        // Missing favicons are fetched by the scheduler when the row is
+        // realized; the item is updated once the icon is cached
+        Evas_Object *icon = favicon_object_add(obj, st);
+        if (icon) return icon;
+        icon = elm_icon_add(obj);
         elm_icon_standard_set(icon, "media-playback-start");
-        if (st->favicon && st->favicon[0] && st->stationuuid)
-        {
-            char cache_path[PATH_MAX];
-            const char *home = getenv("HOME");
-            snprintf(cache_path, sizeof(cache_path), "%s/.cache/eradio/favicons/%s", home, st->stationuuid);
-            if (ecore_file_exists(cache_path))
-            {
-                elm_image_file_set(icon, cache_path, NULL);
-            }
-            else
-            {
-                // We can't easily get the list item here to pass to http_download_icon,
-                // so we'll just show the default icon.
-                // A more advanced implementation might trigger the download differently.
-            }
-        }
+        evas_object_data_set(icon, "placeholder", icon);
         return icon;
     }
     else if (!strcmp(part, "elm.swallow.end"))
     {
-        if (ad->view_mode == VIEW_SEARCH)
+        if (ad->view_mode == VIEW_SEARCH || ad->view_mode == VIEW_FAVORITES)
         {
+            // The buttons find their station through "station", so a
+            // recycled button can be pointed at another row
             Evas_Object *fav_btn = elm_button_add(obj);
-            evas_object_size_hint_min_set(fav_btn, 40, 40);
-            evas_object_propagate_events_set(fav_btn, EINA_FALSE);
-            if (st->favorite)
-                elm_object_text_set(fav_btn, "★");
+            if (ad->view_mode == VIEW_SEARCH)
+            {
+                evas_object_size_hint_min_set(fav_btn, 40, 40);
+                evas_object_smart_callback_add(fav_btn, "clicked", _favorite_btn_clicked_cb, NULL);
+            }
             else
-                elm_object_text_set(fav_btn, "☆");
-            evas_object_smart_callback_add(fav_btn, "clicked", _favorite_btn_clicked_cb, st);
-            evas_object_data_set(fav_btn, "ad", ad);
-            return fav_btn;
-        }
-        else if (ad->view_mode == VIEW_FAVORITES)
-        {
-            Evas_Object *fav_btn = elm_button_add(obj);
-            evas_object_size_hint_min_set(fav_btn, 60, 30);
+            {
+                evas_object_size_hint_min_set(fav_btn, 60, 30);
+                evas_object_smart_callback_add(fav_btn, "clicked", _favorite_remove_btn_clicked_cb, NULL);
+            }
             evas_object_propagate_events_set(fav_btn, EINA_FALSE);
-            elm_object_text_set(fav_btn, "Remove");
-            evas_object_smart_callback_add(fav_btn, "clicked", _favorite_remove_btn_clicked_cb, st);
+            elm_object_text_set(fav_btn, _end_button_text(ad, st));
             evas_object_data_set(fav_btn, "ad", ad);
+            evas_object_data_set(fav_btn, "station", st);
+            evas_object_data_set(fav_btn, "view_mode", (void *)(intptr_t)(ad->view_mode + 1));
             return fav_btn;
         }
     }
     return NULL;
 }
 
+// Genlist keeps the content of rows that scroll away and offers it to the
+// rows that scroll in. Retargeting it here means steady scrolling creates
+// no widgets; returning NULL falls back to _gl_content_get.
+static Evas_Object *
+_gl_reusable_content_get(void *data, Evas_Object *obj, const char *part, Evas_Object *old)
+{
+    Station *st = data;
+    AppData *ad = evas_object_data_get(obj, "ad");
+
+    if (!old) return NULL;
+    if (!strcmp(part, "elm.swallow.icon"))
+    {
+        if (evas_object_data_get(old, "placeholder"))
+            return favicon_has(st) ? NULL : old;
+        return favicon_object_reuse(old, st) ? old : NULL;
+    }
+    else if (!strcmp(part, "elm.swallow.end"))
+    {
+        if ((intptr_t)evas_object_data_get(old, "view_mode") != ad->view_mode + 1)
+            return NULL;
+        evas_object_data_set(old, "station", st);
+        elm_object_text_set(old, _end_button_text(ad, st));
+        return old;
+    }
+    return NULL;
+}
+
 static Eina_Bool
 _gl_state_get(void *data, Evas_Object *obj, const char *part)
 {
@@ -150,10 +146,35 @@ static void
 _gl_del(void *data, Evas_Object *obj)
 {
     // Station data is owned by the ad->stations list, so we don't free it here.
+    Station *st = data;
+    if (!_items) return;
+    if (_playing_item && eina_hash_find(_items, &st) == _playing_item)
+        _playing_item = NULL;
+    eina_hash_del_by_key(_items, &st);
 }
 
 static Elm_Genlist_Item_Class *itc = NULL;
 
+static Eina_List *_populate_next = NULL;        // next node of the shown list to insert
+static Ecore_Animator *_populate_animator = NULL;
+static Eina_Bool _large_mode = EINA_FALSE;
+
+// A refresh keeps the rows of the previous population and diffs the new
+// stations against them by UUID: rows still wanted stay where they are
+// (with their realized widgets), new stations are inserted, rows that
+// moved back are reinserted and the rest go when the refresh ends
+typedef struct _Refresh_Row
+{
+    Elm_Object_Item *it;
+    Eina_Bool kept;         // matched, or deleted as moved
+} Refresh_Row;
+
+static Refresh_Row *_refresh_rows = NULL;       // old rows in list order
+static unsigned int _refresh_count = 0;
+static Eina_Hash *_refresh_index = NULL;        // play key -> row index + 1
+static Elm_Object_Item *_refresh_after = NULL;  // last placed row; NULL: none yet
+static long _refresh_pos = -1;                  // old index of the last kept row
+
 static void _favorite_btn_clicked_cb(void *data, Evas_Object *obj, void *event_info);
 static void _favorite_remove_btn_clicked_cb(void *data, Evas_Object *obj, void *event_info);
 
@@ -173,27 +194,26 @@ _station_click_counter_request(AppData *ad, Station *st)
 static void
 _favorite_btn_clicked_cb(void *data, Evas_Object *obj, void *event_info)
 {
-    Station *st = data;
+    Station *st = evas_object_data_get(obj, "station");
     AppData *ad = evas_object_data_get(obj, "ad");
+    if (!st) return;
     st->favorite = !st->favorite;
     favorites_set(ad, st, st->favorite);
     favorites_save(ad);
-    // Find the genlist item and update it
-    Elm_Object_Item *it = elm_genlist_selected_item_get(ad->list);
-    if (it && elm_object_item_data_get(it) == st)
-        elm_genlist_item_update(it);
+    // The button is the only part of the row that shows the state
+    elm_object_text_set(obj, _end_button_text(ad, st));
 }
 
 static void
 _favorite_remove_btn_clicked_cb(void *data, Evas_Object *obj, void *event_info)
 {
-    Station *st = data;
+    Station *st = evas_object_data_get(obj, "station");
     AppData *ad = evas_object_data_get(obj, "ad");
+    if (!st) return;
     st->favorite = EINA_FALSE;
+    // Removes this row and frees st
     favorites_set(ad, st, EINA_FALSE);
     favorites_save(ad);
-    favorites_rebuild_station_list(ad);
-    station_list_populate_favorites(ad);
 }
 
 void
@@ -210,81 +230,394 @@ _list_item_selected_cb(void *data, Evas_Object *obj, void *event_info)
    fprintf(stderr, "LOG: _list_item_selected_cb: station name='%s', url='%s'\n", st->name, st->url);
 
    _station_click_counter_request(ad, st);
+   station_list_now_playing_set(ad, st);
    radio_player_play(ad, st->url, st->name);
 }
 
+void
+_list_item_realized_cb(void *data, Evas_Object *obj EINA_UNUSED, void *event_info)
+{
+   AppData *ad = data;
+   Elm_Object_Item *it = event_info;
+
+   favicon_item_realized(it);
+
+   if (ad->view_mode != VIEW_SEARCH || !ad->prefetch_trigger) return;
+   if (elm_object_item_data_get(it) == ad->prefetch_trigger)
+     http_search_stations_next_page(ad);
+}
+
+void
+_list_item_unrealized_cb(void *data EINA_UNUSED, Evas_Object *obj EINA_UNUSED, void *event_info)
+{
+   favicon_item_unrealized(event_info);
+}
+
+void
+_list_edge_bottom_cb(void *data, Evas_Object *obj EINA_UNUSED, void *event_info EINA_UNUSED)
+{
+   AppData *ad = data;
+
+   // Backstop for lists shorter than the prefetch margin
+   if (ad->view_mode == VIEW_SEARCH)
+     http_search_stations_next_page(ad);
+}
+
+// In the large-list mode genlist stops measuring rows one by one: every
+// row takes the height of the first (they all share one layout), labels
+// are compressed to the list width instead of widening it, and rows are
+// realized in bigger blocks
+static void
+_large_mode_set(AppData *ad, Eina_Bool on)
+{
+    if (_large_mode == on) return;
+    _large_mode = on;
+    elm_genlist_homogeneous_set(ad->list, on);
+    elm_genlist_mode_set(ad->list, on ? ELM_LIST_COMPRESS : ELM_LIST_SCROLL);
+    elm_genlist_block_count_set(ad->list, on ? LARGE_LIST_BLOCK_COUNT : DEFAULT_BLOCK_COUNT);
+}
+
+static unsigned int
+_large_list_rows(void)
+{
+    const char *rows = getenv("ERADIO_LARGE_LIST_ROWS");
+    return (rows && atoi(rows) > 0) ? (unsigned int)atoi(rows) : LARGE_LIST_ROWS;
+}
+
+void
+station_list_populate_cancel(AppData *ad)
+{
+    if (_populate_animator)
+        ecore_animator_del(_populate_animator);
+    _populate_animator = NULL;
+    _populate_next = NULL;
+}
+
+static void
+_refresh_free(void)
+{
+    free(_refresh_rows);
+    _refresh_rows = NULL;
+    _refresh_count = 0;
+    if (_refresh_index) eina_hash_free(_refresh_index);
+    _refresh_index = NULL;
+    _refresh_after = NULL;
+    _refresh_pos = -1;
+}
+
+// The genlist is being deleted with its window: forget its rows without
+// touching them, and leave ad->list NULL for anything still running
+void
+station_list_shutdown(AppData *ad)
+{
+    _refresh_free();
+    station_list_populate_cancel(ad);
+    if (_items) eina_hash_free(_items);
+    _items = NULL;
+    _playing_item = NULL;
+    eina_stringshare_del(_playing_key);
+    _playing_key = NULL;
+    _large_mode = EINA_FALSE;
+    ad->list = NULL;
+}
+
 void
 station_list_clear(AppData *ad)
 {
+    _refresh_free();
+    station_list_populate_cancel(ad);
+    favicon_cancel_all();
     elm_genlist_clear(ad->list);
+    _large_mode_set(ad, EINA_FALSE);
+    ad->displayed_stations_count = 0;
 }
 
-void
-station_list_populate(AppData *ad, Eina_Bool new_search)
+static void
+_itc_ensure(void)
 {
-    Eina_List *l;
-    Station *st;
+    if (itc) return;
+
+    itc = elm_genlist_item_class_new();
+    itc->item_style = "default";
+    itc->func.text_get = _gl_text_get;
+    itc->func.content_get = _gl_content_get;
+    itc->func.reusable_content_get = _gl_reusable_content_get;
+    itc->func.state_get = _gl_state_get;
+    itc->func.del = _gl_del;
+}
 
-    if (!itc)
+static void
+_item_append(AppData *ad, Station *st)
+{
+    Elm_Object_Item *it = elm_genlist_item_append(ad->list,
+                                                  itc,
+                                                  st,
+                                                  NULL,
+                                                  ELM_GENLIST_ITEM_NONE,
+                                                  _list_item_selected_cb,
+                                                  ad);
+    if (!it) return;
+    if (!_items) _items = eina_hash_pointer_new(NULL);
+    eina_hash_set(_items, &st, it);
+    if (_station_is_playing(st)) _playing_item = it;
+}
+
+static void
+_station_item_append(AppData *ad, Station *st)
+{
+    _item_append(ad, st);
+    ad->displayed_stations_count++;
+}
+
+// Insert queued rows until this frame's budget is spent
+static Eina_Bool
+_populate_slice_cb(void *data)
+{
+    AppData *ad = data;
+    double deadline = ecore_time_get() + POPULATE_SLICE_BUDGET;
+    int n = 0;
+
+    while (_populate_next)
     {
-        itc = elm_genlist_item_class_new();
-        itc->item_style = "default";
-        itc->func.text_get = _gl_text_get;
-        itc->func.content_get = _gl_content_get;
-        itc->func.state_get = _gl_state_get;
-        itc->func.del = _gl_del;
+        _station_item_append(ad, eina_list_data_get(_populate_next));
+        _populate_next = eina_list_next(_populate_next);
+        if (++n % POPULATE_CHECK_ROWS == 0 && ecore_time_get() >= deadline)
+            return ECORE_CALLBACK_RENEW;
     }
+    _populate_animator = NULL;
+    return ECORE_CALLBACK_CANCEL;
+}
 
-    if (new_search)
+// Point a kept row at the station replacing its old one. Only rows whose
+// text, icon or button actually change are redrawn.
+static void
+_item_retarget(AppData *ad, Elm_Object_Item *it, Station *st)
+{
+    Station *old = elm_object_item_data_get(it);
+    Evas_Object *end = elm_object_item_part_content_get(it, "elm.swallow.end");
+
+    eina_hash_del_by_key(_items, &old);
+    eina_hash_set(_items, &st, it);
+    elm_object_item_data_set(it, st);
+    if (_station_is_playing(st)) _playing_item = it;
+
+    if (old->label != st->label || old->favorite != st->favorite || old->favicon != st->favicon ||
+        (end && (intptr_t)evas_object_data_get(end, "view_mode") != ad->view_mode + 1))
+        elm_genlist_item_update(it);
+    else if (end)
+        evas_object_data_set(end, "station", st);
+}
+
+// Rows are removed through here during a refresh, so favicon fetches stop
+// waiting for them even if they were only prefetched, never realized
+static void
+_item_del(Elm_Object_Item *it)
+{
+    favicon_item_unrealized(it);
+    elm_object_item_del(it);
+}
+
+static void
+_refresh_place(AppData *ad, Station *st)
+{
+    const char *key = _station_play_key(st);
+    uintptr_t idx = key ? (uintptr_t)eina_hash_find(_refresh_index, &key) : 0;
+    Refresh_Row *row = (idx && !_refresh_rows[idx - 1].kept) ? &_refresh_rows[idx - 1] : NULL;
+    Elm_Object_Item *it;
+
+    if (row && (long)(idx - 1) > _refresh_pos)
+    {
+        // Still in order: the row stays, rows skipped over wait for the end
+        row->kept = EINA_TRUE;
+        _refresh_pos = idx - 1;
+        _item_retarget(ad, row->it, st);
+        it = row->it;
+    }
+    else
     {
-      station_list_clear(ad);
-      ad->displayed_stations_count = 0;
+        // New, or moved back past rows already placed
+        if (row)
+        {
+            row->kept = EINA_TRUE;
+            _item_del(row->it);
+        }
+        if (_refresh_after)
+            it = elm_genlist_item_insert_after(ad->list, itc, st, NULL, _refresh_after,
+                                               ELM_GENLIST_ITEM_NONE, _list_item_selected_cb, ad);
+        else
+            it = elm_genlist_item_prepend(ad->list, itc, st, NULL,
+                                          ELM_GENLIST_ITEM_NONE, _list_item_selected_cb, ad);
+        if (!it) return;
+        eina_hash_set(_items, &st, it);
+        if (_station_is_playing(st)) _playing_item = it;
     }
+    _refresh_after = it;
+    ad->displayed_stations_count++;
+}
 
-    evas_object_data_set(ad->list, "ad", ad);
-    Eina_List *stations_to_display = ad->stations;
+void
+station_list_refresh_begin(AppData *ad)
+{
+    Elm_Object_Item *it;
+    unsigned int n = elm_genlist_items_count(ad->list), i = 0;
 
-    EINA_LIST_FOREACH(stations_to_display, l, st)
+    station_list_refresh_end(ad);
+    station_list_populate_cancel(ad);
+    if (!n || !_items) return;
+
+    _refresh_rows = calloc(n, sizeof(Refresh_Row));
+    _refresh_index = eina_hash_pointer_new(NULL);
+    if (!_refresh_rows || !_refresh_index)
     {
-        elm_genlist_item_append(ad->list,
-                                itc,
-                                st,
-                                NULL,
-                                ELM_GENLIST_ITEM_NONE,
-                                _list_item_selected_cb,
-                                ad);
+        _refresh_free();
+        station_list_clear(ad);
+        return;
     }
-}
+    for (it = elm_genlist_first_item_get(ad->list); it && i < n; it = elm_genlist_item_next_get(it), i++)
+    {
+        const Station *st = elm_object_item_data_get(it);
+        const char *key = _station_play_key(st);
 
+        _refresh_rows[i].it = it;
+        // A duplicate UUID keeps its first row; the others are removed
+        if (key && !eina_hash_find(_refresh_index, &key))
+            eina_hash_add(_refresh_index, &key, (void *)(uintptr_t)(i + 1));
+    }
+    _refresh_count = i;
+    ad->displayed_stations_count = 0;
+}
 
+void
+station_list_refresh_end(AppData *ad)
+{
+    if (!_refresh_rows) return;
+    for (unsigned int i = 0; i < _refresh_count; i++)
+        if (!_refresh_rows[i].kept)
+            _item_del(_refresh_rows[i].it);
+    _refresh_free();
+    if (ad->displayed_stations_count < (int)_large_list_rows())
+        _large_mode_set(ad, EINA_FALSE);
+}
 
+// Rows are inserted in time-sliced steps from an animator, so a large
+// result set never blocks input or rendering. The first screenful goes in
+// at once. stations must be a tail of the list the view shows
+// (ad->stations or ad->favorites_stations): when rows are still queued it
+// is already reachable from the queue and nothing more is done.
 void
-station_list_populate_favorites(AppData *ad)
+station_list_append(AppData *ad, Eina_List *stations)
 {
-    Eina_List *l;
-    Station *st;
+    _itc_ensure();
+    evas_object_data_set(ad->list, "ad", ad);
 
-    if (!itc)
+    // stations shares the count of the whole result set it is a tail of
+    if (_refresh_rows && eina_list_count(stations) >= _large_list_rows())
     {
-        itc = elm_genlist_item_class_new();
-        itc->item_style = "default";
-        itc->func.text_get = _gl_text_get;
-        itc->func.content_get = _gl_content_get;
-        itc->func.state_get = _gl_state_get;
-        itc->func.del = _gl_del;
+        // Diffing is bounded work per station; a large set is cheaper to
+        // rebuild in slices. stations may be only the latest batch, so the
+        // rebuild starts over from the head of the shown list.
+        station_list_clear(ad);
+        stations = (ad->view_mode == VIEW_FAVORITES) ? ad->favorites_stations : ad->stations;
     }
+    if (eina_list_count(stations) >= _large_list_rows())
+        _large_mode_set(ad, EINA_TRUE);
 
-    station_list_clear(ad);
-    evas_object_data_set(ad->list, "ad", ad);
+    if (_refresh_rows)
+    {
+        Eina_List *l;
+        Station *st;
+
+        EINA_LIST_FOREACH(stations, l, st)
+            _refresh_place(ad, st);
+        return;
+    }
+
+    if (_populate_next || !stations) return;
 
-    EINA_LIST_FOREACH(ad->favorites_stations, l, st)
+    _populate_next = stations;
+    while (_populate_next && ad->displayed_stations_count < POPULATE_FIRST_ROWS)
     {
-        elm_genlist_item_append(ad->list,
-                                itc,
-                                st,
-                                NULL,
-                                ELM_GENLIST_ITEM_NONE,
-                                _list_item_selected_cb,
-                                ad);
+        _station_item_append(ad, eina_list_data_get(_populate_next));
+        _populate_next = eina_list_next(_populate_next);
     }
-}
\ No newline at end of file
+    if (_populate_next && !_populate_animator)
+        _populate_animator = ecore_animator_add(_populate_slice_cb, ad);
+}
+
+void
+station_list_populate(AppData *ad, Eina_Bool new_search)
+{
+    if (!new_search)
+    {
+        station_list_append(ad, ad->stations);
+        return;
+    }
+
+    // The rows already shown (say, favorites) are diffed against the
+    // stations, so stations on both keep their rows
+    station_list_refresh_begin(ad);
+    station_list_append(ad, ad->stations);
+    station_list_refresh_end(ad);
+}
+
+
+
+// Rows a search already shows for a favorite are kept
+void
+station_list_populate_favorites(AppData *ad)
+{
+    station_list_refresh_begin(ad);
+    station_list_append(ad, ad->favorites_stations);
+    station_list_refresh_end(ad);
+}
+
+void
+station_list_favorite_added(AppData *ad, Station *st)
+{
+    if (ad->view_mode != VIEW_FAVORITES) return;
+    // A queue still draining the favorites list reaches st by itself
+    if (_populate_next) return;
+    _itc_ensure();
+    _station_item_append(ad, st);
+}
+
+void
+station_list_station_removed(AppData *ad, Station *st)
+{
+    Elm_Object_Item *it = station_list_item_get(st);
+
+    if (_populate_next && eina_list_data_get(_populate_next) == st)
+        _populate_next = eina_list_next(_populate_next);
+    if (!it) return;
+    _item_del(it);
+    ad->displayed_stations_count--;
+}
+
+void
+station_list_station_changed(AppData *ad EINA_UNUSED, Station *st)
+{
+    Elm_Object_Item *it = station_list_item_get(st);
+    if (it) elm_genlist_item_update(it);
+}
+
+Elm_Object_Item *
+station_list_item_get(const Station *st)
+{
+    return (_items && st) ? eina_hash_find(_items, &st) : NULL;
+}
+
+void
+station_list_now_playing_set(AppData *ad, const Station *st)
+{
+    Elm_Object_Item *old = _playing_item;
+
+    eina_stringshare_del(_playing_key);
+    _playing_key = st ? eina_stringshare_ref(_station_play_key(st)) : NULL;
+    _playing_item = station_list_item_get(st);
+
+    // Only the row losing the mark and the row gaining it are redrawn
+    if (old && old != _playing_item)
+        elm_genlist_item_fields_update(old, "elm.text", ELM_GENLIST_ITEM_FIELD_TEXT);
+    if (_playing_item)
+        elm_genlist_item_fields_update(_playing_item, "elm.text", ELM_GENLIST_ITEM_FIELD_TEXT);
+}
@@ -3,6 +3,31 @@
 #include "appdata.h"
 
 void station_list_populate(AppData *ad, Eina_Bool new_search);
+void station_list_append(AppData *ad, Eina_List *stations);
 void station_list_populate_favorites(AppData *ad);
 void station_list_clear(AppData *ad);
+// Called when the genlist is deleted
+void station_list_shutdown(AppData *ad);
+// Stop inserting the rows still queued by station_list_append
+void station_list_populate_cancel(AppData *ad);
+// Diffing refresh: after station_list_refresh_begin the rows already
+// shown are matched by UUID against the stations appended next, so rows
+// that stay keep their place and widgets. Rows not matched are removed by
+// station_list_refresh_end; their stations must stay valid until then.
+void station_list_refresh_begin(AppData *ad);
+void station_list_refresh_end(AppData *ad);
+// Keep the favorites view in step with ad->favorites_stations one
+// station at a time: st was appended to it, is about to be removed from
+// it and freed, or had its fields updated
+void station_list_favorite_added(AppData *ad, Station *st);
+void station_list_station_removed(AppData *ad, Station *st);
+void station_list_station_changed(AppData *ad, Station *st);
+// Row showing st, or NULL if st is not in the list (yet)
+Elm_Object_Item *station_list_item_get(const Station *st);
+// Mark st's row as playing (NULL: nothing plays); the mark follows the
+// station's UUID across searches
+void station_list_now_playing_set(AppData *ad, const Station *st);
 void _list_item_selected_cb(void *data, Evas_Object *obj, void *event_info);
+void _list_item_realized_cb(void *data, Evas_Object *obj, void *event_info);
+void _list_item_unrealized_cb(void *data, Evas_Object *obj, void *event_info);
+void _list_edge_bottom_cb(void *data, Evas_Object *obj, void *event_info);
@@ -0,0 +1,264 @@
+#include <libxml/parser.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "station_parser.h"
+#include "json_tokenizer.h"
+
+struct _Station_Parser
+{
+    ApiFormat format;
+    xmlParserCtxtPtr ctxt;
+    xmlSAXHandler sax;
+    Json_Tokenizer json;
+    Station *current;     // JSON station object being filled in
+    char key[32];         // JSON key awaiting its value
+    Eina_List *pending;   // stations completed during the current chunk
+    Station_Parser_Batch_Cb batch_cb;
+    void *data;
+    int count;
+};
+
+void
+station_free(Station *st)
+{
+    if (!st) return;
+    eina_stringshare_del(st->name);
+    eina_stringshare_del(st->url);
+    eina_stringshare_del(st->favicon);
+    eina_stringshare_del(st->stationuuid);
+    eina_stringshare_del(st->country);
+    eina_stringshare_del(st->language);
+    eina_stringshare_del(st->codec);
+    eina_stringshare_del(st->tags);
+    eina_stringshare_del(st->label);
+    free(st);
+}
+
+static void
+_label_info_add(Eina_Strbuf *buf, Eina_Bool *first, const char *text)
+{
+    if (!text || !text[0]) return;
+    eina_strbuf_append(buf, *first ? " • " : " | ");
+    eina_strbuf_append(buf, text);
+    *first = EINA_FALSE;
+}
+
+void
+station_label_update(Station *st)
+{
+    Eina_Strbuf *buf = eina_strbuf_new();
+    Eina_Bool first = EINA_TRUE;
+
+    if (!buf) return;
+    eina_strbuf_append(buf, st->name ? st->name : "");
+    if (st->bitrate > 0)
+    {
+        eina_strbuf_append_printf(buf, " • %d kbps", st->bitrate);
+        first = EINA_FALSE;
+    }
+    _label_info_add(buf, &first, st->codec);
+    _label_info_add(buf, &first, st->country);
+    _label_info_add(buf, &first, st->language);
+    if (st->tags && st->tags[0])
+    {
+        eina_strbuf_append(buf, " • ");
+        eina_strbuf_append(buf, st->tags);
+    }
+    eina_stringshare_replace(&st->label, eina_strbuf_string_get(buf));
+    eina_strbuf_free(buf);
+}
+
+static void
+_station_attr_set(Station *st, const char *name, const char *value)
+{
+    if (!value) return;
+
+    if (!strcmp(name, "name"))
+        eina_stringshare_replace(&st->name, value);
+    else if (!strcmp(name, "url_resolved"))
+        eina_stringshare_replace(&st->url, value);
+    else if (!strcmp(name, "favicon"))
+        eina_stringshare_replace(&st->favicon, value);
+    else if (!strcmp(name, "stationuuid"))
+        eina_stringshare_replace(&st->stationuuid, value);
+    else if (!strcmp(name, "country"))
+        eina_stringshare_replace(&st->country, value);
+    else if (!strcmp(name, "language"))
+        eina_stringshare_replace(&st->language, value);
+    else if (!strcmp(name, "codec"))
+        eina_stringshare_replace(&st->codec, value);
+    else if (!strcmp(name, "tags"))
+        eina_stringshare_replace(&st->tags, value);
+    else if (!strcmp(name, "bitrate"))
+        st->bitrate = atoi(value);
+}
+
+static void
+_pending_add(Station_Parser *p, Station *st)
+{
+    // The row text is built here, once, instead of on every realize
+    station_label_update(st);
+
+    // Add to pending batch - check for failure to avoid memory leak
+    Eina_List *new_list = eina_list_append(p->pending, st);
+    if (!new_list)
+    {
+        station_free(st);
+        return;
+    }
+    p->pending = new_list;
+}
+
+// radio-browser sends every field as an attribute of an empty <station/>
+// element, so a Station is complete as soon as its start tag is seen.
+static void
+_sax_start_element(void *ctx, const xmlChar *name, const xmlChar **attrs)
+{
+    Station_Parser *p = ctx;
+
+    if (xmlStrcmp(name, (const xmlChar *)"station") != 0) return;
+
+    Station *st = calloc(1, sizeof(Station));
+    if (!st) return;
+
+    for (int i = 0; attrs && attrs[i]; i += 2)
+        _station_attr_set(st, (const char *)attrs[i], (const char *)attrs[i + 1]);
+
+    _pending_add(p, st);
+}
+
+// The response is an array of flat station objects (depth 2); values of
+// nested containers are skipped, and every scalar is written straight
+// into the Station being built.
+static void
+_json_token_cb(void *data, Json_Token_Type type, const char *text, size_t len, int depth)
+{
+    Station_Parser *p = data;
+
+    if (depth != 2) return;
+
+    switch (type)
+    {
+    case JSON_TOKEN_OBJECT_START:
+        station_free(p->current);
+        p->current = calloc(1, sizeof(Station));
+        p->key[0] = '\0';
+        break;
+    case JSON_TOKEN_OBJECT_END:
+        if (p->current) _pending_add(p, p->current);
+        p->current = NULL;
+        break;
+    case JSON_TOKEN_KEY:
+        if (len >= sizeof(p->key)) len = sizeof(p->key) - 1;
+        memcpy(p->key, text, len);
+        p->key[len] = '\0';
+        break;
+    case JSON_TOKEN_STRING:
+    case JSON_TOKEN_NUMBER:
+        if (p->current && text[0])
+            _station_attr_set(p->current, p->key, text);
+        break;
+    default:
+        break;
+    }
+}
+
+static void
+_flush_pending(Station_Parser *p)
+{
+    Eina_List *batch = p->pending;
+
+    if (!batch) return;
+    p->pending = NULL;
+    p->count += eina_list_count(batch);
+    p->batch_cb(p->data, batch);
+}
+
+Station_Parser *
+station_parser_new(ApiFormat format, Station_Parser_Batch_Cb batch_cb, const void *data)
+{
+    Station_Parser *p = calloc(1, sizeof(Station_Parser));
+    if (!p) return NULL;
+
+    p->format = format;
+    p->batch_cb = batch_cb;
+    p->data = (void *)data;
+    if (format == API_FORMAT_JSON)
+        json_tokenizer_init(&p->json, _json_token_cb, p);
+    else
+        p->sax.startElement = _sax_start_element;
+    return p;
+}
+
+Eina_Bool
+station_parser_feed(Station_Parser *p, const char *buf, int len)
+{
+    if (!p) return EINA_FALSE;
+
+    if (p->format == API_FORMAT_JSON)
+    {
+        Eina_Bool ok = json_tokenizer_feed(&p->json, buf, len);
+        _flush_pending(p);
+        return ok;
+    }
+
+    if (!p->ctxt)
+    {
+        p->ctxt = xmlCreatePushParserCtxt(&p->sax, p, buf, len, "noname.xml");
+        if (!p->ctxt) return EINA_FALSE;
+    }
+    else if (xmlParseChunk(p->ctxt, buf, len, 0) != 0 && !p->ctxt->wellFormed)
+    {
+        _flush_pending(p);
+        return EINA_FALSE;
+    }
+
+    _flush_pending(p);
+    return EINA_TRUE;
+}
+
+Eina_Bool
+station_parser_finish(Station_Parser *p)
+{
+    Eina_Bool ok;
+
+    if (!p) return EINA_FALSE;
+
+    if (p->format == API_FORMAT_JSON)
+    {
+        ok = json_tokenizer_finish(&p->json);
+        _flush_pending(p);
+        return ok || p->count > 0;
+    }
+
+    if (!p->ctxt) return EINA_FALSE;
+
+    xmlParseChunk(p->ctxt, "", 0, 1);
+    _flush_pending(p);
+
+    // A truncated but otherwise valid response still yields usable stations
+    ok = p->ctxt->wellFormed || p->count > 0;
+    xmlFreeParserCtxt(p->ctxt);
+    p->ctxt = NULL;
+    return ok;
+}
+
+int
+station_parser_count_get(const Station_Parser *p)
+{
+    return p ? p->count : 0;
+}
+
+void
+station_parser_free(Station_Parser *p)
+{
+    Station *st;
+
+    if (!p) return;
+    if (p->ctxt) xmlFreeParserCtxt(p->ctxt);
+    station_free(p->current);
+    EINA_LIST_FREE(p->pending, st)
+        station_free(st);
+    free(p);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "appdata.h"
+
+typedef struct _Station_Parser Station_Parser;
+
+// Called with a list of freshly built stations; ownership of the list and
+// of every Station in it passes to the callback.
+typedef void (*Station_Parser_Batch_Cb)(void *data, Eina_List *batch);
+
+// Create a streaming parser for a radio-browser station search response
+// in the given format (/xml/stations/search or /json/stations/search)
+Station_Parser *station_parser_new(ApiFormat format, Station_Parser_Batch_Cb batch_cb, const void *data);
+
+// Feed the next chunk of the response; completed stations are delivered
+// through the batch callback before this returns
+Eina_Bool station_parser_feed(Station_Parser *p, const char *buf, int len);
+
+// Signal end of input and flush any remaining stations. Returns EINA_FALSE
+// if the response could not be parsed and produced no stations.
+Eina_Bool station_parser_finish(Station_Parser *p);
+
+// Number of stations delivered so far
+int station_parser_count_get(const Station_Parser *p);
+
+void station_parser_free(Station_Parser *p);
+
+// Release a Station and all of its strings
+void station_free(Station *st);
+
+// Rebuild st->label, the "name • bitrate | codec | country | language • tags"
+// line shown in the list, after the station's fields have changed
+void station_label_update(Station *st);
@@ -0,0 +1,574 @@
+#include <Ecore_File.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "thumbs.h"
+
+#define THUMB_BASE_SIZE 32        // icon size at scale 1.0
+#define THUMB_KEY_MAX 64
+#define ATLAS_MIN_SLOTS 64
+#define THUMB_LOAD_MAX (4 * _size)  // larger sources are decoded scaled down
+#define THUMB_RECORD_DELETED 1      // Thumb_Record.flags: key's slot was freed
+
+typedef struct _Thumb_Record
+{
+   char key[THUMB_KEY_MAX];
+   uint32_t slot;
+   uint32_t flags;
+} Thumb_Record;
+
+static Evas *_evas = NULL;
+static int _size = THUMB_BASE_SIZE;
+static int _atlas_fd = -1;
+static uint32_t *_atlas = NULL;      // capacity slots of _size * _size pixels
+static size_t _capacity = 0;
+static size_t _count = 0;            // slots below this have been used
+static uint32_t *_free = NULL;       // freed slots below _count, lowest last
+static size_t _free_count = 0;
+static size_t _free_size = 0;
+static FILE *_index = NULL;          // opened for appending
+static size_t _records = 0;          // records read from the index
+static Eina_Hash *_slots = NULL;     // key -> slot + 1
+static Eina_List *_jobs = NULL;      // decodes in progress
+
+struct _Thumbs_Job
+{
+   char key[THUMB_KEY_MAX];
+   Evas_Object *img;       // preloading; NULL once the pixels are copied
+   uint32_t *src;          // decoded pixels, w * h, unpadded
+   int w, h;
+   uint32_t *pixels;       // scaled by the worker thread
+   Ecore_Thread *thread;
+   Thumbs_Done_Cb cb;      // NULL once cancelled
+   void *data;
+};
+
+static void _job_free(Thumbs_Job *job);
+
+static size_t
+_slot_bytes(void)
+{
+   return (size_t)_size * _size * sizeof(uint32_t);
+}
+
+static Eina_Bool
+_thumbs_path_get(char *buf, size_t len, const char *name)
+{
+   const char *home = getenv("HOME");
+   if (!home) return EINA_FALSE;
+   snprintf(buf, len, "%s/.cache/eradio/thumbs/%s-%d", home, name, _size);
+   return EINA_TRUE;
+}
+
+static Eina_Bool
+_atlas_map(size_t capacity)
+{
+   void *map;
+
+   if (ftruncate(_atlas_fd, capacity * _slot_bytes()) == -1) return EINA_FALSE;
+   map = mmap(NULL, capacity * _slot_bytes(), PROT_READ | PROT_WRITE, MAP_SHARED, _atlas_fd, 0);
+   if (map == MAP_FAILED) return EINA_FALSE;
+   if (_atlas) munmap(_atlas, _capacity * _slot_bytes());
+   _atlas = map;
+   _capacity = capacity;
+   return EINA_TRUE;
+}
+
+static void
+_index_load(const char *path)
+{
+   Thumb_Record rec;
+   FILE *f = fopen(path, "rb");
+
+   if (!f) return;
+   while (fread(&rec, sizeof(rec), 1, f) == 1)
+     {
+        _records++;
+        rec.key[THUMB_KEY_MAX - 1] = '\0';
+        if (rec.slot >= _capacity) continue;   // atlas write never made it to disk
+        if (rec.flags & THUMB_RECORD_DELETED)
+          eina_hash_del_by_key(_slots, rec.key);
+        else
+          eina_hash_set(_slots, rec.key, (void *)(uintptr_t)(rec.slot + 1));
+        if (rec.slot >= _count) _count = rec.slot + 1;
+     }
+   fclose(f);
+}
+
+static void
+_index_write(const Thumb_Record *rec)
+{
+   if (!_index) return;
+   fwrite(rec, sizeof(*rec), 1, _index);
+   fflush(_index);
+}
+
+static void
+_free_push(uint32_t slot)
+{
+   if (_free_count == _free_size)
+     {
+        size_t size = _free_size ? _free_size * 2 : ATLAS_MIN_SLOTS;
+        uint32_t *grown = realloc(_free, size * sizeof(uint32_t));
+        if (!grown) return;   // the slot stays unused until the next compaction
+        _free = grown;
+        _free_size = size;
+     }
+   _free[_free_count++] = slot;
+}
+
+static Eina_Bool
+_owner_cb(const Eina_Hash *hash EINA_UNUSED, const void *key, void *data, void *fdata)
+{
+   const char **owner = fdata;
+   owner[(uintptr_t)data - 1] = key;
+   return EINA_TRUE;
+}
+
+// Write a fresh index for the n slots in owner, through a temporary file
+static Eina_Bool
+_index_rewrite(const char *path, const char **owner, size_t n)
+{
+   char tmp[PATH_MAX + 8];
+   FILE *f;
+
+   snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+   f = fopen(tmp, "wb");
+   if (!f) return EINA_FALSE;
+   for (size_t i = 0; i < n; i++)
+     {
+        Thumb_Record rec = {{0}};
+        snprintf(rec.key, sizeof(rec.key), "%s", owner[i]);
+        rec.slot = i;
+        fwrite(&rec, sizeof(rec), 1, f);
+     }
+   if (fclose(f) != 0 || rename(tmp, path) == -1)
+     {
+        unlink(tmp);
+        return EINA_FALSE;
+     }
+   return EINA_TRUE;
+}
+
+// Freed slots are reused before the atlas grows. Once most of the atlas
+// (or of the index) is dead weight, live slots are moved down, the index
+// is rewritten and the file shrinks.
+static void
+_atlas_settle(const char *index_path)
+{
+   size_t live = eina_hash_population(_slots), used = 0, capacity;
+   const char **owner;
+
+   if (!_count) return;
+   owner = calloc(_count, sizeof(char *));
+   if (!owner) return;
+   eina_hash_foreach(_slots, _owner_cb, owner);
+
+   if (live * 2 >= _count && _records <= 2 * (live + ATLAS_MIN_SLOTS))
+     {
+        for (size_t i = _count; i-- > 0;)
+          if (!owner[i]) _free_push(i);
+        free(owner);
+        return;
+     }
+
+   // Without an index a crash mid-move only costs the thumbnails, which
+   // are decoded again from the icon cache
+   unlink(index_path);
+   for (size_t i = 0; i < _count; i++)
+     {
+        if (!owner[i]) continue;
+        if (i != used)
+          {
+             memcpy(_atlas + used * _size * _size, _atlas + i * _size * _size, _slot_bytes());
+             eina_hash_modify(_slots, owner[i], (void *)(uintptr_t)(used + 1));
+          }
+        owner[used++] = owner[i];
+     }
+   printf("Thumbnail atlas: compacted %zu slots into %zu\n", _count, used);
+   _count = used;
+   if (!_index_rewrite(index_path, owner, used))
+     {
+        // Nothing on disk says which slot is which any more
+        eina_hash_free_buckets(_slots);
+        _count = 0;
+     }
+   free(owner);
+
+   for (capacity = ATLAS_MIN_SLOTS; capacity < _count; capacity *= 2) ;
+   if (capacity < _capacity) _atlas_map(capacity);
+}
+
+void
+thumbs_init(Evas_Object *win)
+{
+   char path[PATH_MAX], dir[PATH_MAX];
+   struct stat st;
+   size_t capacity;
+
+   _evas = evas_object_evas_get(win);
+   _size = (int)(THUMB_BASE_SIZE * elm_config_scale_get() + 0.5);
+   if (_size < 16) _size = 16;
+   if (_size > 128) _size = 128;
+   _slots = eina_hash_string_superfast_new(NULL);
+
+   if (!_thumbs_path_get(path, sizeof(path), "atlas")) return;
+   snprintf(dir, sizeof(dir), "%s", path);
+   *strrchr(dir, '/') = '\0';
+   ecore_file_mkpath(dir);
+
+   _atlas_fd = open(path, O_RDWR | O_CREAT, 0644);
+   if (_atlas_fd == -1) return;
+   capacity = (fstat(_atlas_fd, &st) == 0) ? st.st_size / _slot_bytes() : 0;
+   if (capacity < ATLAS_MIN_SLOTS) capacity = ATLAS_MIN_SLOTS;
+   if (!_atlas_map(capacity))
+     {
+        close(_atlas_fd);
+        _atlas_fd = -1;
+        return;
+     }
+
+   _thumbs_path_get(path, sizeof(path), "index");
+   _index_load(path);
+   _atlas_settle(path);
+   _index = fopen(path, "ab");
+   printf("Thumbnail atlas: %zu of %zu %dx%d slots in use\n", _count - _free_count, _capacity, _size, _size);
+}
+
+void
+thumbs_shutdown(void)
+{
+   Thumbs_Job *job;
+   Eina_List *l, *l_next;
+
+   EINA_LIST_FOREACH_SAFE(_jobs, l, l_next, job)
+     {
+        job->cb = NULL;
+        if (job->thread)
+          {
+             // A running worker is not waited for; its callback frees the
+             // job and finds no atlas to write to
+             _jobs = eina_list_remove_list(_jobs, l);
+             ecore_thread_cancel(job->thread);
+          }
+        else
+          _job_free(job);
+     }
+   if (_index) fclose(_index);
+   _index = NULL;
+   if (_atlas) munmap(_atlas, _capacity * _slot_bytes());
+   _atlas = NULL;
+   _capacity = _count = 0;
+   free(_free);
+   _free = NULL;
+   _free_count = _free_size = 0;
+   _records = 0;
+   if (_atlas_fd != -1) close(_atlas_fd);
+   _atlas_fd = -1;
+   if (_slots) eina_hash_free(_slots);
+   _slots = NULL;
+}
+
+int
+thumbs_size_get(void)
+{
+   return _size;
+}
+
+Eina_Bool
+thumbs_has(const char *key)
+{
+   return _slots && key && eina_hash_find(_slots, key) != NULL;
+}
+
+// Box-filter the premultiplied ARGB source into a _size x _size slot,
+// keeping the aspect ratio and centering it on a transparent background
+static void
+_scale_into(uint32_t *dst, const uint32_t *src, int sw, int sh, int stride)
+{
+   int dw = _size, dh = _size, ox, oy;
+
+   if (sw > sh) dh = (sh * _size + sw / 2) / sw;
+   else if (sh > sw) dw = (sw * _size + sh / 2) / sh;
+   if (dw < 1) dw = 1;
+   if (dh < 1) dh = 1;
+   ox = (_size - dw) / 2;
+   oy = (_size - dh) / 2;
+
+   memset(dst, 0, _slot_bytes());
+   for (int y = 0; y < dh; y++)
+     {
+        int y0 = y * sh / dh, y1 = (y + 1) * sh / dh;
+        if (y1 <= y0) y1 = y0 + 1;
+
+        for (int x = 0; x < dw; x++)
+          {
+             int x0 = x * sw / dw, x1 = (x + 1) * sw / dw;
+             uint32_t a = 0, r = 0, g = 0, b = 0, n;
+             if (x1 <= x0) x1 = x0 + 1;
+
+             for (int sy = y0; sy < y1; sy++)
+               {
+                  const uint32_t *row = (const uint32_t *)((const char *)src + (size_t)sy * stride);
+                  for (int sx = x0; sx < x1; sx++)
+                    {
+                       uint32_t p = row[sx];
+                       a += p >> 24;
+                       r += (p >> 16) & 0xff;
+                       g += (p >> 8) & 0xff;
+                       b += p & 0xff;
+                    }
+               }
+             n = (y1 - y0) * (x1 - x0);
+             dst[(oy + y) * _size + ox + x] = ((a / n) << 24) | ((r / n) << 16) | ((g / n) << 8) | (b / n);
+          }
+     }
+}
+
+// Copy scaled pixels into key's slot and record it in the index
+static Eina_Bool
+_store(const char *key, const uint32_t *pixels)
+{
+   Thumb_Record rec = {{0}};
+   uintptr_t slot;
+
+   if (!_atlas) return EINA_FALSE;
+   slot = (uintptr_t)eina_hash_find(_slots, key);
+   if (slot)
+     slot--;
+   else if (_free_count)
+     slot = _free[--_free_count];
+   else
+     {
+        if (_count >= _capacity && !_atlas_map(_capacity * 2)) return EINA_FALSE;
+        slot = _count++;
+     }
+   memcpy(_atlas + slot * _size * _size, pixels, _slot_bytes());
+
+   // The index entry goes after the pixels, so a crash leaves at worst an
+   // unreferenced slot
+   if (!eina_hash_find(_slots, key))
+     {
+        eina_hash_add(_slots, key, (void *)(slot + 1));
+        strcpy(rec.key, key);
+        rec.slot = slot;
+        _index_write(&rec);
+     }
+   return EINA_TRUE;
+}
+
+void
+thumbs_del(const char *key)
+{
+   Thumb_Record rec = {{0}};
+   uintptr_t slot = (_slots && key) ? (uintptr_t)eina_hash_find(_slots, key) : 0;
+
+   if (!slot) return;
+   strcpy(rec.key, key);
+   rec.slot = slot - 1;
+   rec.flags = THUMB_RECORD_DELETED;
+   eina_hash_del_by_key(_slots, key);
+   _free_push(slot - 1);
+   _index_write(&rec);
+}
+
+typedef struct _Prune
+{
+   Thumbs_Keep_Cb keep;
+   Eina_List *gone;
+} Prune;
+
+static Eina_Bool
+_prune_cb(const Eina_Hash *hash EINA_UNUSED, const void *key, void *data EINA_UNUSED, void *fdata)
+{
+   Prune *p = fdata;
+
+   if (!p->keep(key)) p->gone = eina_list_append(p->gone, eina_stringshare_add(key));
+   return EINA_TRUE;
+}
+
+void
+thumbs_prune(Thumbs_Keep_Cb keep)
+{
+   Prune p = { keep, NULL };
+   const char *key;
+   int n = 0;
+
+   if (!_slots) return;
+   eina_hash_foreach(_slots, _prune_cb, &p);
+   EINA_LIST_FREE(p.gone, key)
+     {
+        thumbs_del(key);
+        eina_stringshare_del(key);
+        n++;
+     }
+   if (n) printf("Thumbnail atlas: dropped %d thumbnails without a cached icon\n", n);
+}
+
+static void
+_job_free(Thumbs_Job *job)
+{
+   _jobs = eina_list_remove(_jobs, job);
+   if (job->img) evas_object_del(job->img);
+   free(job->src);
+   free(job->pixels);
+   free(job);
+}
+
+static void
+_job_finish(Thumbs_Job *job, Eina_Bool ok)
+{
+   Thumbs_Done_Cb cb = job->cb;
+   void *data = job->data;
+   char key[THUMB_KEY_MAX];
+
+   if (ok) ok = _store(job->key, job->pixels);
+   strcpy(key, job->key);
+   _job_free(job);
+   if (cb) cb(data, key, ok);
+}
+
+static void
+_scale_blocking(void *data, Ecore_Thread *thread EINA_UNUSED)
+{
+   Thumbs_Job *job = data;
+
+   job->pixels = malloc(_slot_bytes());
+   if (job->pixels)
+     _scale_into(job->pixels, job->src, job->w, job->h, job->w * sizeof(uint32_t));
+}
+
+static void
+_scale_end(void *data, Ecore_Thread *thread EINA_UNUSED)
+{
+   Thumbs_Job *job = data;
+
+   job->thread = NULL;
+   _job_finish(job, job->pixels != NULL);
+}
+
+static void
+_scale_cancel(void *data, Ecore_Thread *thread EINA_UNUSED)
+{
+   Thumbs_Job *job = data;
+
+   job->thread = NULL;
+   _job_finish(job, EINA_FALSE);
+}
+
+// The loader thread has decoded the file. Its pixels are copied out so the
+// image object can go, and the box filter runs on the thread pool.
+static void
+_preloaded_cb(void *data, Evas *e EINA_UNUSED, Evas_Object *obj, void *event_info EINA_UNUSED)
+{
+   Thumbs_Job *job = data;
+   const uint32_t *pixels;
+   int stride;
+
+   evas_object_image_size_get(obj, &job->w, &job->h);
+   pixels = evas_object_image_data_get(obj, EINA_FALSE);
+   stride = evas_object_image_stride_get(obj);
+   if (evas_object_image_load_error_get(obj) != EVAS_LOAD_ERROR_NONE || !pixels ||
+       job->w <= 0 || job->h <= 0 ||
+       !(job->src = malloc((size_t)job->w * job->h * sizeof(uint32_t))))
+     {
+        _job_finish(job, EINA_FALSE);
+        return;
+     }
+   for (int y = 0; y < job->h; y++)
+     memcpy(job->src + (size_t)y * job->w, (const char *)pixels + (size_t)y * stride,
+            job->w * sizeof(uint32_t));
+   evas_object_del(job->img);
+   job->img = NULL;
+
+   job->thread = ecore_thread_run(_scale_blocking, _scale_end, _scale_cancel, job);
+   if (!job->thread && eina_list_data_find(_jobs, job))
+     _job_finish(job, EINA_FALSE);
+}
+
+Thumbs_Job *
+thumbs_add_file(const char *key, const char *path, Thumbs_Done_Cb cb, const void *data)
+{
+   Thumbs_Job *job;
+   int w = 0, h = 0;
+
+   if (!_atlas || !key || strlen(key) >= THUMB_KEY_MAX) return NULL;
+   job = calloc(1, sizeof(Thumbs_Job));
+   if (!job) return NULL;
+   strcpy(job->key, key);
+   job->cb = cb;
+   job->data = (void *)data;
+
+   // Only the header is read here; the decode itself happens in Evas'
+   // preload thread
+   job->img = evas_object_image_add(_evas);
+   evas_object_image_file_set(job->img, path, NULL);
+   if (evas_object_image_load_error_get(job->img) != EVAS_LOAD_ERROR_NONE)
+     {
+        evas_object_del(job->img);
+        free(job);
+        return NULL;
+     }
+   // Loaders that can decode at a reduced size (JPEG, SVG, large PNGs) do
+   // so, which keeps the pixel copy and the filter small
+   evas_object_image_size_get(job->img, &w, &h);
+   if (w > THUMB_LOAD_MAX || h > THUMB_LOAD_MAX)
+     {
+        if (w >= h)
+          evas_object_image_load_size_set(job->img, THUMB_LOAD_MAX, h * THUMB_LOAD_MAX / w + 1);
+        else
+          evas_object_image_load_size_set(job->img, w * THUMB_LOAD_MAX / h + 1, THUMB_LOAD_MAX);
+     }
+   _jobs = eina_list_append(_jobs, job);
+   evas_object_event_callback_add(job->img, EVAS_CALLBACK_IMAGE_PRELOADED, _preloaded_cb, job);
+   evas_object_image_preload(job->img, EINA_FALSE);
+   return job;
+}
+
+void
+thumbs_add_cancel(Thumbs_Job *job)
+{
+   if (!job) return;
+   job->cb = NULL;
+   // A running scale cannot be interrupted; its end callback frees the job
+   if (job->thread)
+     ecore_thread_cancel(job->thread);
+   else
+     _job_free(job);
+}
+
+Eina_Bool
+thumbs_object_set(Evas_Object *img, const char *key)
+{
+   uintptr_t slot = _slots && key ? (uintptr_t)eina_hash_find(_slots, key) : 0;
+
+   if (!slot || !_atlas || !evas_object_data_get(img, "thumbs")) return EINA_FALSE;
+
+   // Copy the slot out of the mapping, which may move when the atlas grows
+   evas_object_image_data_copy_set(img, _atlas + (slot - 1) * _size * _size);
+   evas_object_image_data_update_add(img, 0, 0, _size, _size);
+   return EINA_TRUE;
+}
+
+Evas_Object *
+thumbs_object_add(Evas_Object *parent, const char *key)
+{
+   Evas_Object *img;
+
+   if (!thumbs_has(key) || !_atlas) return NULL;
+
+   img = evas_object_image_filled_add(evas_object_evas_get(parent));
+   evas_object_data_set(img, "thumbs", img);
+   evas_object_image_alpha_set(img, EINA_TRUE);
+   evas_object_image_size_set(img, _size, _size);
+   evas_object_size_hint_min_set(img, _size, _size);
+   evas_object_size_hint_max_set(img, _size, _size);
+   thumbs_object_set(img, key);
+   return img;
+}
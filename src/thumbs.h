@@ -0,0 +1,44 @@
+#pragma once
+
+#include <Elementary.h>
+
+// Favicon thumbnails, decoded once and scaled to the row icon size for the
+// current elm_config_scale, stored as fixed-size ARGB slots in one
+// memory-mapped atlas file (~/.cache/eradio/thumbs/atlas-<size>) with an
+// append-only index of key -> slot next to it. Deleted thumbnails free
+// their slot for reuse; a mostly empty atlas is compacted at startup.
+
+// Map the atlas for the current scale; win provides the canvas used to decode
+void thumbs_init(Evas_Object *win);
+void thumbs_shutdown(void);
+
+// Thumbnail edge length in pixels
+int thumbs_size_get(void);
+
+Eina_Bool thumbs_has(const char *key);
+
+// Free key's slot
+void thumbs_del(const char *key);
+
+// Delete every thumbnail whose key keep() rejects
+typedef Eina_Bool (*Thumbs_Keep_Cb)(const char *key);
+void thumbs_prune(Thumbs_Keep_Cb keep);
+
+typedef struct _Thumbs_Job Thumbs_Job;
+typedef void (*Thumbs_Done_Cb)(void *data, const char *key, Eina_Bool ok);
+
+// Decode the image file at path, scale it and store it under key. Decoding
+// runs in Evas' preload thread and scaling on the Ecore thread pool; cb is
+// called on the main loop once the thumbnail is stored (or failed). Returns
+// NULL, without calling cb, if path is not a readable image.
+Thumbs_Job *thumbs_add_file(const char *key, const char *path, Thumbs_Done_Cb cb, const void *data);
+
+// Abandon a decode; its callback is not called
+void thumbs_add_cancel(Thumbs_Job *job);
+
+// New image object showing the thumbnail for key, or NULL if there is none
+Evas_Object *thumbs_object_add(Evas_Object *parent, const char *key);
+
+// Show the thumbnail for key in img, an object from thumbs_object_add().
+// Returns EINA_FALSE if there is no such thumbnail.
+Eina_Bool thumbs_object_set(Evas_Object *img, const char *key);
@@ -2,8 +2,11 @@
 #include "appdata.h"
 #include "favorites.h"
 #include "station_list.h"
+#include "frame_stats.h"
 #include "http.h" // Include http.h for http_search_stations
 
+#define SERVER_AUTO_LABEL "auto"
+
 static void _win_del_cb(void *data, Evas_Object *obj, void *event_info);
 static void _app_exit_cb(void *data, Evas_Object *obj, void *event_info);
 static void _hoversel_item_selected_cb(void *data, Evas_Object *obj, void *event_info);
@@ -19,9 +22,12 @@ void _stop_btn_clicked_cb(void *data, Evas_Object *obj, void *event_info);
 void _visualizer_btn_clicked_cb(void *data, Evas_Object *obj, void *event_info);
 void _search_btn_clicked_cb(void *data, Evas_Object *obj, void *event_info);
 void _search_entry_activated_cb(void *data, Evas_Object *obj, void *event_info);
+void _search_entry_changed_cb(void *data, Evas_Object *obj, void *event_info);
 void _list_item_selected_cb(void *data, Evas_Object *obj, void *event_info);
+void _list_item_realized_cb(void *data, Evas_Object *obj, void *event_info);
+void _list_item_unrealized_cb(void *data, Evas_Object *obj, void *event_info);
+void _list_edge_bottom_cb(void *data, Evas_Object *obj, void *event_info);
 static void _favorites_btn_clicked_cb(void *data, Evas_Object *obj, void *event_info);
-static void _load_more_btn_clicked_cb(void *data, Evas_Object *obj, void *event_info);
 static void _error_dialog_ok_clicked_cb(void *data, Evas_Object *obj, void *event_info);
 static void _volume_slider_changed_cb(void *data, Evas_Object *obj, void *event_info);
 
@@ -32,6 +38,12 @@ _win_del_cb(void *data, Evas_Object *obj, void *event_info)
    elm_exit();
 }
 
+static void
+_list_del_cb(void *data, Evas *e EINA_UNUSED, Evas_Object *obj EINA_UNUSED, void *event_info EINA_UNUSED)
+{
+   station_list_shutdown(data);
+}
+
 static void
 _app_exit_cb(void *data, Evas_Object *obj, void *event_info)
 {
@@ -191,6 +203,11 @@ ui_create(AppData *ad)
    elm_box_pack_end(search_options_box, ad->reverse_check);
    evas_object_show(ad->reverse_check);
 
+   ad->instant_search_check = elm_check_add(ad->win);
+   elm_object_text_set(ad->instant_search_check, "Search as you type");
+   elm_box_pack_end(search_options_box, ad->instant_search_check);
+   evas_object_show(ad->instant_search_check);
+
    // Server selection hoversel, populated after HTTP init discovers servers
    ad->server_hoversel = elm_hoversel_add(ad->win);
    elm_hoversel_hover_parent_set(ad->server_hoversel, ad->win);
@@ -255,7 +272,14 @@ ui_create(AppData *ad)
 
    evas_object_smart_callback_add(ad->search_btn, "clicked", _search_btn_clicked_cb, ad);
    evas_object_smart_callback_add(ad->search_entry, "activated", _search_entry_activated_cb, ad);
+   evas_object_smart_callback_add(ad->search_entry, "changed,user", _search_entry_changed_cb, ad);
    evas_object_smart_callback_add(ad->list, "selected", _list_item_selected_cb, ad);
+   // Scrolling near the end of the results fetches the next page
+   evas_object_smart_callback_add(ad->list, "realized", _list_item_realized_cb, ad);
+   evas_object_smart_callback_add(ad->list, "unrealized", _list_item_unrealized_cb, ad);
+   evas_object_smart_callback_add(ad->list, "edge,bottom", _list_edge_bottom_cb, ad);
+   frame_stats_attach(ad->list);
+   evas_object_event_callback_add(ad->list, EVAS_CALLBACK_DEL, _list_del_cb, ad);
 
 
    /* Default to Search view on startup */
@@ -322,12 +346,18 @@ void ui_update_server_list(AppData *ad)
 {
    if (!ad || !ad->server_hoversel) return;
    Eina_List *l; const char *host;
+   // Called again whenever discovery finds new mirrors
+   elm_hoversel_clear(ad->server_hoversel);
+   // "auto" lets http.c rank servers by measured latency and failures
+   elm_hoversel_item_add(ad->server_hoversel, SERVER_AUTO_LABEL, NULL, ELM_ICON_NONE, _server_item_selected_cb, ad);
    EINA_LIST_FOREACH(ad->api_servers, l, host)
    {
       elm_hoversel_item_add(ad->server_hoversel, host, NULL, ELM_ICON_NONE, _server_item_selected_cb, ad);
    }
    if (ad->api_selected && ad->api_selected[0])
       elm_object_text_set(ad->server_hoversel, ad->api_selected);
+   else
+      elm_object_text_set(ad->server_hoversel, SERVER_AUTO_LABEL);
 }
 
 static void _server_item_selected_cb(void *data, Evas_Object *obj, void *event_info)
@@ -340,7 +370,7 @@ static void _server_item_selected_cb(void *data, Evas_Object *obj, void *event_i
    {
       elm_object_text_set(obj, label);
       if (ad->api_selected) eina_stringshare_del(ad->api_selected);
-      ad->api_selected = eina_stringshare_add(label);
+      ad->api_selected = strcmp(label, SERVER_AUTO_LABEL) ? eina_stringshare_add(label) : NULL;
    }
 }
 
@@ -497,11 +527,9 @@ _url_dialog_ok_clicked_cb(void *data, Evas_Object *obj, void *event_info)
    station->stationuuid = NULL;
    station->favorite = EINA_TRUE; // Mark as favorite since it's being added to favorites
 
-   // Add to favorites
+   // Add to favorites; this also adds it to the favorites station list
    favorites_set(ad, station, EINA_TRUE);
-
-   // Rebuild the favorites station list to include the new station
-   favorites_rebuild_station_list(ad);
+   favorites_save(ad);
 
    // Close the dialog
    evas_object_del(inwin);